@@ -0,0 +1,137 @@
+// File: 'ProggyCleanTT.ttf' (41208 bytes)
+// Exported using binary_to_compressed_c.exe -u8 -lz4 "ProggyCleanTT.ttf" ProggyClean
+static const unsigned int ProggyClean_lz4_size = 8344;
+static const unsigned char ProggyClean_lz4_data[8344] =
+{
+    76,90,52,66,248,160,0,0,241,34,0,1,0,0,0,12,0,128,0,3,0,64,79,83,47,50,136,235,116,144,0,0,1,72,0,0,0,78,99,109,97,112,2,18,35,117,0,0,3,160,0,0,1,82,99,118,116,32,0,1,0,240,66,4,252,
+    0,0,0,2,103,108,121,102,18,175,137,86,0,0,7,4,0,0,146,128,104,101,97,100,215,145,102,211,0,0,0,204,0,0,0,54,104,104,101,97,8,66,1,195,0,0,1,4,0,0,0,36,104,109,116,120,138,0,126,128,
+    0,0,1,152,0,0,2,6,108,111,99,97,140,115,176,216,0,0,5,79,0,241,50,4,109,97,120,112,1,174,0,218,0,0,1,40,0,0,0,32,110,97,109,101,37,89,187,150,0,0,153,132,0,0,1,158,112,111,115,116,
+    166,172,131,239,0,0,155,36,0,0,5,210,112,114,101,112,105,2,1,18,0,0,4,244,0,0,0,8,204,0,225,1,0,0,60,85,233,213,95,15,60,245,0,3,8,174,0,64,183,103,119,132,8,0,160,189,146,166,215,
+    0,0,254,128,3,128,112,0,66,0,3,0,2,206,0,0,52,0,129,4,192,254,64,0,0,3,128,25,0,17,128,74,0,8,1,0,16,2,18,0,99,1,1,0,144,0,36,16,0,162,8,0,64,0,10,0,0,0,118,0,101,0,80,0,3,128,1,144,
+    201,0,130,2,188,2,138,0,0,0,143,8,0,66,1,197,0,50,103,0,43,4,9,84,0,3,1,0,162,65,108,116,115,0,64,0,0,32,172,73,0,66,5,0,1,128,138,0,47,3,128,2,0,47,33,1,128,203,0,0,216,0,1,12,0,16,
+    1,12,0,1,2,0,6,10,0,10,2,0,16,1,6,0,4,28,0,13,36,0,5,54,0,10,26,0,2,98,0,4,104,0,3,4,0,1,89,1,15,64,0,2,3,148,0,12,86,0,6,156,0,1,14,0,48,3,128,0,194,0,4,78,0,9,112,0,2,28,0,2,224,
+    0,9,148,0,3,74,0,0,32,0,1,148,1,4,26,0,0,86,1,7,120,0,2,234,1,7,112,0,1,102,0,3,46,0,15,252,0,3,7,16,0,0,116,0,1,120,0,15,68,1,4,9,140,0,15,64,0,9,15,62,0,5,6,52,0,0,168,2,2,1,0,19,
+    28,150,2,49,76,0,3,10,0,81,28,0,4,0,48,248,2,17,8,202,2,113,127,0,255,32,172,255,255,36,0,17,129,10,0,88,1,0,1,223,213,204,2,47,1,6,132,2,3,15,1,0,180,31,129,39,0,19,131,177,0,1,141,
+    184,1,255,133,15,0,31,198,2,0,48,241,204,244,1,28,1,158,2,20,2,136,2,252,3,20,3,88,3,156,3,222,4,20,4,50,4,80,4,98,4,162,5,22,5,102,5,188,6,18,6,116,6,214,7,56,7,126,7,236,8,78,8,108,
+    8,150,8,208,9,16,9,74,9,136,10,22,10,128,11,4,11,86,11,200,12,46,12,130,12,234,13,94,13,164,13,234,14,80,14,150,15,40,15,176,16,18,16,116,16,224,17,82,17,182,18,4,18,110,18,196,19,
+    76,19,172,19,246,20,88,20,174,20,234,21,64,21,128,21,166,21,184,22,18,22,126,22,198,23,52,23,142,23,224,24,86,24,186,24,238,25,54,25,150,25,212,26,72,26,156,26,240,27,92,27,200,28,
+    4,28,76,28,150,28,234,29,42,29,146,29,210,30,64,30,142,30,224,31,36,31,118,31,166,31,166,32,16,32,16,32,46,32,138,32,178,32,200,33,20,33,116,33,152,33,238,34,98,34,134,35,12,35,12,
+    35,128,2,0,240,206,152,35,176,35,216,36,0,36,74,36,104,36,144,36,174,37,6,37,96,37,130,37,248,37,248,38,88,38,170,38,170,38,216,39,64,39,154,40,10,40,104,40,168,41,14,41,32,41,184,
+    41,248,42,54,42,96,42,96,43,2,43,42,43,94,43,172,43,230,44,32,44,52,44,154,45,40,45,92,45,120,45,170,45,232,46,38,46,166,47,38,47,182,47,244,48,94,48,200,49,62,49,180,50,30,50,158,
+    51,30,51,130,51,238,52,92,52,206,53,58,53,134,53,212,54,38,54,114,54,230,55,118,55,216,56,58,56,166,57,18,57,116,57,174,58,46,58,154,59,6,59,124,59,232,60,58,60,150,61,34,61,134,61,
+    236,62,86,62,198,63,42,63,154,64,18,64,106,64,208,65,54,65,162,66,8,66,64,66,122,66,184,66,240,67,98,67,204,68,42,68,138,68,238,69,88,69,182,69,226,70,84,70,180,71,20,71,122,71,218,
+    72,84,72,198,73,64,212,5,3,22,6,255,63,3,0,7,0,11,0,15,0,19,0,23,0,27,0,31,0,35,0,39,0,43,0,47,0,51,0,55,0,59,0,63,0,67,0,71,0,75,0,79,0,83,0,87,0,91,0,95,0,99,0,103,0,107,0,111,0,
+    115,0,119,0,123,0,127,0,131,0,135,0,139,0,143,0,0,17,53,51,21,49,4,0,4,95,5,53,51,21,33,8,0,68,15,116,0,5,18,128,1,0,79,252,128,128,2,6,0,46,2,1,0,20,4,9,0,15,1,0,58,32,0,7,140,5,60,
+    2,0,4,140,1,111,0,1,53,51,21,7,4,0,0,90,3,53,51,21,1,69,0,30,3,88,0,112,255,0,128,128,0,6,1,245,7,32,128,4,238,8,6,92,0,1,90,0,19,51,64,1,8,8,0,96,1,0,128,128,128,254,62,0,1,5,0,16,
+    4,15,0,8,171,0,32,0,24,63,4,45,3,128,172,0,15,56,2,15,15,116,0,2,15,44,2,5,15,40,0,33,1,18,1,1,183,0,19,253,175,0,1,8,0,15,18,0,4,15,49,1,0,15,1,0,19,142,0,0,21,0,128,255,128,3,176,
+    1,15,4,1,9,1,254,0,12,202,0,15,234,0,9,15,6,1,13,0,16,0,18,1,229,1,8,215,0,1,16,0,1,5,0,7,248,0,16,255,253,7,15,234,0,33,63,0,0,20,240,1,30,39,0,19,156,3,0,186,0,8,198,0,8,12,0,0,202,
+    2,15,28,0,5,4,12,0,0,72,0,98,128,128,1,128,128,253,138,2,3,200,1,20,254,152,2,3,9,0,3,23,0,16,253,215,8,15,235,0,31,2,232,0,1,60,9,15,232,0,25,0,210,1,15,220,4,5,0,24,0,8,20,0,8,208,
+    0,15,188,4,1,4,124,3,80,254,128,128,1,0,214,0,0,6,0,17,128,13,0,0,213,0,0,230,0,2,221,0,17,253,14,1,3,247,0,15,234,0,32,48,3,1,128,5,12,5,16,4,9,100,4,3,84,4,6,246,3,110,0,0,11,1,0,
+    255,64,4,6,24,1,5,216,2,0,64,0,4,8,0,7,4,0,19,29,96,0,1,8,0,39,2,0,160,2,6,1,0,12,102,4,15,184,0,1,15,136,0,17,9,108,0,12,52,5,8,164,0,1,80,1,6,1,0,4,148,0,15,136,0,18,1,74,11,0,161,
+    10,15,16,1,12,8,198,2,12,212,3,4,24,0,0,202,1,2,89,0,1,209,1,3,214,1,17,254,117,6,15,132,0,8,31,9,132,0,8,5,208,1,15,54,5,1,4,4,1,6,42,5,3,7,0,15,112,0,5,48,0,0,4,179,1,1,82,13,4,108,
+    0,43,0,37,86,1,3,78,1,11,213,1,1,215,13,18,128,110,2,7,168,0,1,30,4,15,170,7,3,8,210,6,33,0,2,217,14,4,120,0,5,116,0,7,186,1,51,0,0,10,136,5,15,20,2,3,9,10,1,15,8,0,9,1,253,0,6,152,
+    2,6,5,0,15,16,2,12,3,52,4,15,8,6,25,5,52,4,15,56,4,5,15,8,5,9,15,56,4,1,2,176,7,7,26,4,4,10,5,5,7,0,10,52,4,15,28,5,34,31,14,232,0,18,9,226,6,8,228,5,12,134,3,12,254,1,3,198,6,3,144,
+    2,2,1,0,3,13,0,15,175,0,18,47,0,15,136,1,20,15,126,1,2,4,150,0,8,4,0,0,20,0,13,166,0,6,106,1,1,176,0,5,3,0,15,170,0,24,15,172,0,53,23,49,228,4,15,22,2,12,5,75,1,15,5,2,31,47,0,17,20,
+    7,24,15,254,1,2,15,186,2,9,15,152,4,1,23,2,10,2,2,4,7,9,213,2,2,110,1,15,195,2,24,79,0,0,0,18,164,3,26,15,158,4,2,8,214,6,7,24,0,15,130,1,10,2,128,0,4,184,0,4,13,0,15,134,3,34,19,0,
+    136,1,15,196,0,19,9,150,8,15,204,2,1,15,148,1,1,13,64,2,2,55,2,4,221,2,11,96,4,15,198,0,32,2,112,21,15,196,0,11,15,124,1,2,15,184,5,9,4,93,0,11,182,5,15,151,0,14,47,0,19,184,5,28,15,
+    182,5,14,15,92,1,26,12,178,5,4,251,7,15,99,1,44,1,218,0,15,44,2,36,15,188,0,21,8,146,1,4,24,0,15,130,6,1,6,162,10,0,147,1,0,207,3,15,44,2,26,18,4,16,15,7,224,8,5,204,7,0,250,14,7,170,
+    10,5,186,8,3,229,4,50,0,0,6,176,8,11,28,9,13,64,0,15,10,10,0,43,255,0,77,0,4,83,0,1,244,22,15,244,9,7,9,114,3,7,8,0,1,32,4,7,8,0,0,254,10,1,23,1,4,27,1,15,229,9,7,2,160,24,95,1,0,3,
+    128,2,240,10,5,15,48,3,4,1,146,1,15,24,0,4,3,93,0,3,74,13,16,128,143,0,6,1,0,10,190,9,1,92,9,1,110,22,15,244,0,4,3,124,0,13,228,0,11,4,1,4,116,0,4,247,0,15,243,0,10,1,116,0,15,188,
+    2,7,15,190,7,14,5,26,17,14,170,7,0,1,0,15,131,2,6,1,40,17,31,26,216,16,38,0,16,19,15,74,3,10,0,20,0,12,212,9,15,16,0,5,4,48,0,3,72,0,5,88,1,15,62,4,1,3,24,14,6,159,18,8,9,0,2,51,14,
+    2,15,0,15,235,16,38,0,1,0,5,68,7,15,28,1,21,15,16,3,2,15,82,4,9,15,122,4,5,0,192,1,3,15,8,6,20,15,4,239,16,17,2,25,15,5,6,0,15,82,7,28,0,200,18,15,240,15,29,5,200,18,12,120,3,15,230,
+    8,17,15,94,5,21,5,52,3,15,212,11,3,11,246,0,3,203,3,15,203,18,40,3,220,11,15,8,1,13,15,224,2,6,12,234,15,15,74,8,1,6,176,2,3,1,0,15,222,6,26,15,156,17,35,15,164,1,17,15,88,22,25,1,
+    139,0,5,148,1,14,135,1,2,6,0,5,172,1,15,103,13,31,15,148,8,30,15,170,10,24,12,170,1,15,26,6,4,6,174,10,5,95,19,15,204,0,32,47,0,0,228,12,23,15,196,0,41,15,180,0,6,15,222,12,21,15,216,
+    4,38,15,4,3,5,11,188,5,15,94,11,10,10,20,3,4,224,19,0,70,2,15,38,12,38,15,40,3,38,15,88,25,25,15,56,3,13,15,163,4,5,15,48,3,3,15,185,5,29,3,233,0,16,12,28,18,31,2,232,0,9,13,172,1,
+    12,136,16,12,140,16,1,130,1,9,4,9,15,76,12,20,1,216,12,15,140,0,23,15,136,0,1,15,140,0,2,8,1,0,15,14,2,19,4,252,11,15,176,15,20,15,250,1,9,15,184,20,1,15,238,1,9,3,170,6,3,159,7,4,
+    63,26,3,181,7,4,50,5,15,184,15,27,15,48,14,20,15,80,1,5,15,230,4,7,10,1,0,15,86,1,16,31,0,28,10,45,4,24,29,4,32,4,4,90,1,8,16,0,15,24,10,17,8,122,1,15,142,1,3,0,90,4,0,5,10,4,8,0,1,
+    1,0,11,22,10,41,1,0,9,0,5,229,28,15,37,10,44,15,80,9,48,8,120,4,8,138,2,15,12,0,1,0,8,0,8,28,1,12,64,11,8,12,0,2,17,1,0,137,4,4,114,5,2,86,25,13,94,25,4,8,0,6,7,0,15,90,9,39,31,16,
+    16,1,22,15,72,26,10,15,164,8,17,3,174,17,2,46,19,15,155,8,3,2,141,3,15,209,0,25,0,243,2,15,76,16,26,15,114,9,25,15,216,7,5,1,122,0,14,76,16,2,229,7,15,244,26,31,0,196,0,17,18,36,24,
+    15,188,12,34,15,140,1,33,4,244,22,15,148,1,25,15,214,0,28,15,20,11,82,15,40,0,17,1,139,0,15,174,1,8,15,0,6,39,3,230,0,15,160,9,40,11,184,0,12,168,16,1,8,0,15,240,0,5,2,128,7,5,184,
+    1,1,1,0,5,180,1,15,152,9,33,31,14,64,6,18,15,64,35,14,15,232,6,5,3,106,0,9,181,11,15,93,13,22,15,100,1,28,15,54,8,9,15,80,13,27,15,68,13,5,14,39,3,15,115,1,30,15,112,1,24,15,180,0,
+    13,12,130,33,1,112,1,5,52,7,13,147,31,6,131,33,15,220,14,21,15,80,35,40,12,192,0,15,12,0,1,15,88,8,13,4,180,4,15,232,3,1,3,232,0,14,52,8,2,1,0,5,9,0,6,155,33,5,13,1,15,56,7,82,15,188,
+    12,13,8,8,0,15,190,10,9,9,141,5,6,113,18,8,185,5,15,55,7,23,31,12,208,1,14,15,120,2,10,8,104,2,5,224,3,11,112,2,1,106,2,15,121,28,23,15,228,3,34,15,132,4,1,8,108,21,8,4,0,15,108,11,
+    1,9,112,11,8,46,29,6,100,13,15,212,3,27,31,15,0,34,12,15,56,29,6,15,34,12,9,12,42,12,6,254,38,14,1,0,15,29,34,15,5,172,0,15,152,32,12,3,184,12,12,174,34,13,190,34,15,130,0,28,31,0,
+    36,1,35,15,32,1,17,8,190,5,13,158,14,2,1,0,15,47,40,2,15,173,0,8,18,10,28,34,15,188,33,17,12,132,5,8,52,3,4,228,23,7,53,30,4,132,4,15,141,0,8,32,0,0,84,34,0,24,10,1,108,46,9,116,41,
+    31,21,134,7,8,15,78,0,4,17,2,170,25,4,204,0,5,138,36,0,42,1,3,133,0,19,0,216,4,15,56,36,7,15,16,12,0,8,168,8,15,144,9,13,14,192,8,5,42,23,11,147,27,15,91,36,9,10,35,1,5,148,20,15,80,
+    2,13,9,148,20,15,130,15,5,15,34,8,31,5,1,0,15,100,10,2,5,106,10,15,117,2,23,4,218,0,3,92,16,15,140,1,8,15,236,19,18,13,22,3,5,168,0,0,1,0,4,113,1,15,112,1,12,15,104,1,34,8,224,38,15,
+    174,11,21,15,104,1,5,4,244,28,13,47,2,14,59,2,15,106,1,31,15,248,2,37,15,174,0,6,8,214,5,15,132,1,15,1,7,0,15,137,1,20,7,181,0,4,240,36,15,144,1,11,15,106,6,2,15,142,1,1,12,78,5,4,
+    0,22,4,197,7,7,113,6,15,98,1,19,0,88,1,16,21,175,8,15,88,1,18,11,132,44,15,44,2,41,15,16,6,7,15,57,2,11,5,241,0,15,132,1,20,11,238,0,4,136,16,15,32,3,17,15,132,4,46,5,218,14,5,183,
+    0,15,124,4,5,15,100,6,11,15,200,0,0,17,8,184,22,15,200,0,1,1,154,1,4,158,1,15,130,7,1,5,234,45,4,1,0,0,122,0,15,170,8,2,2,60,21,15,8,8,12,15,112,0,14,12,230,1,4,186,43,7,1,0,1,209,
+    1,15,135,0,6,8,145,0,3,4,4,15,192,1,16,13,190,1,15,32,11,5,15,210,1,5,4,117,0,15,146,22,12,15,169,8,24,0,152,32,15,184,1,6,9,152,32,15,70,9,13,15,58,9,1,15,137,0,11,6,128,47,15,232,
+    3,24,9,72,16,12,220,13,15,48,14,13,15,12,0,1,2,140,0,2,33,21,11,10,14,15,9,0,5,15,232,3,28,6,116,5,15,232,0,12,15,216,29,38,1,103,0,15,204,3,11,15,180,0,16,15,168,0,23,15,90,37,21,
+    15,196,6,11,15,77,5,1,15,167,0,19,0,84,8,15,32,6,26,15,90,1,34,15,234,6,5,15,110,1,13,6,174,18,15,17,6,29,15,216,0,31,15,244,6,53,6,194,3,15,236,6,15,15,216,0,32,3,252,36,15,112,37,
+    9,8,204,3,0,8,0,12,148,10,8,122,1,3,193,16,15,141,0,14,47,0,13,208,2,16,15,68,1,1,8,74,21,15,166,12,2,5,44,1,6,7,0,15,21,1,14,64,0,0,0,13,108,5,15,116,24,12,9,0,11,15,110,9,8,9,62,
+    37,6,126,5,8,168,1,15,133,16,16,15,156,4,26,15,140,4,17,12,42,1,15,79,2,4,15,181,13,28,6,64,39,15,68,2,9,15,80,7,5,9,224,20,15,213,20,6,15,73,2,9,1,108,25,15,172,6,25,15,192,20,34,
+    15,212,6,1,15,168,20,12,9,159,20,15,152,3,24,15,80,1,26,8,64,1,8,16,0,2,124,6,9,181,19,2,174,16,1,29,5,15,80,1,12,15,196,5,34,15,130,2,33,15,242,9,1,15,150,2,16,0,1,0,15,215,11,34,
+    15,240,7,39,4,174,0,0,170,0,8,4,0,12,36,0,4,106,0,12,120,20,15,73,3,18,16,14,47,0,15,0,14,23,12,132,5,3,144,0,12,134,54,10,8,44,4,110,0,9,61,11,15,151,10,21,16,0,16,55,0,228,11,15,
+    164,0,7,15,60,60,6,15,94,12,4,15,1,0,1,15,16,55,17,15,44,1,20,8,48,44,15,20,1,1,15,68,1,4,9,114,19,9,52,1,15,43,1,24,0,174,68,47,1,128,76,45,2,9,96,2,8,34,3,8,72,2,5,86,4,12,52,45,
+    4,97,0,2,192,17,0,78,20,15,148,8,32,15,80,9,9,15,20,0,1,13,50,10,1,18,1,7,78,38,5,185,49,0,241,12,4,61,36,15,186,17,26,0,52,1,17,4,76,22,0,73,67,4,212,0,14,248,55,2,46,0,14,248,55,
+    31,16,20,2,18,13,252,32,12,130,4,15,24,2,1,12,32,2,5,76,3,13,75,17,15,39,2,27,1,186,0,104,6,1,0,255,128,2,236,56,0,184,0,1,248,0,12,40,7,4,176,59,7,44,63,12,78,0,0,70,0,1,228,4,1,106,
+    72,0,80,0,24,0,206,6,11,44,0,3,136,9,15,52,1,10,15,220,57,18,15,220,3,2,8,236,57,4,1,0,15,27,1,17,15,124,17,28,15,160,0,13,15,184,0,17,11,176,0,12,186,0,15,114,17,27,1,132,58,0,102,
+    6,9,192,0,9,164,59,4,84,3,4,98,17,15,33,16,1,15,40,45,27,12,96,9,4,18,1,0,8,0,12,212,37,4,12,0,26,2,225,46,6,85,3,7,152,36,15,83,30,21,0,28,20,0,172,0,15,220,67,26,9,158,65,15,120,
+    4,8,15,74,33,31,5,125,7,15,82,33,7,15,88,67,34,1,220,1,0,69,0,9,68,8,5,130,1,3,172,0,2,138,25,6,134,0,12,1,8,2,12,48,15,132,31,38,4,64,6,4,148,10,12,166,5,15,84,6,1,15,150,9,13,8,76,
+    0,3,166,0,2,128,6,6,84,35,3,18,2,11,20,0,15,77,36,35,10,13,1,15,60,2,62,15,182,9,9,4,22,3,15,48,0,1,4,60,2,6,180,4,15,71,30,3,15,60,2,36,2,8,65,6,36,21,4,188,4,4,48,2,11,7,65,33,0,
+    3,72,69,15,56,65,0,5,10,7,9,65,64,2,120,69,13,56,5,15,120,69,16,15,122,62,2,1,216,54,15,200,69,36,15,80,0,3,0,112,6,15,92,12,13,13,180,68,15,192,5,5,8,12,0,7,72,5,5,127,0,6,91,55,15,
+    1,0,6,3,172,5,15,48,64,38,0,120,29,0,228,9,13,208,29,15,86,37,9,3,61,0,12,255,10,1,0,9,3,112,1,7,0,9,12,108,1,4,172,19,9,113,3,2,244,26,0,190,56,15,196,34,18,15,172,21,1,8,36,4,12,
+    16,0,12,60,6,3,118,0,15,198,42,1,11,153,0,15,1,0,7,15,160,23,25,8,4,1,15,22,18,38,8,18,6,6,7,0,5,164,2,12,105,24,14,177,0,2,44,2,14,252,5,27,19,122,0,0,4,0,3,82,0,15,131,2,0,47,0,21,
+    92,23,30,30,83,242,5,4,142,1,15,234,5,1,15,238,5,1,15,234,5,1,3,7,1,10,98,23,11,247,5,4,180,44,15,69,27,32,8,204,43,15,200,9,22,15,230,1,5,15,204,5,5,15,192,5,14,12,188,5,15,240,1,
+    23,2,176,4,2,164,7,15,32,11,14,1,154,3,15,98,7,8,12,98,37,4,41,57,15,101,37,8,2,170,0,15,167,0,11,0,159,0,15,200,75,10,8,122,60,15,124,15,8,0,178,3,15,106,0,0,3,200,44,0,228,81,15,
+    92,19,18,15,186,5,1,12,8,40,12,8,0,15,92,27,1,11,206,5,6,104,74,8,184,70,0,95,74,15,97,14,25,7,24,32,15,32,47,29,15,36,14,9,15,78,8,5,3,140,45,9,36,14,15,184,67,29,9,140,27,15,232,
+    15,21,3,140,27,15,26,11,1,15,26,4,1,15,70,11,5,8,44,0,3,161,2,0,1,0,15,90,25,5,1,90,11,15,243,15,29,3,184,15,15,8,11,21,15,196,40,18,15,200,0,5,1,100,22,15,111,3,4,8,239,13,15,172,
+    48,26,31,10,16,19,10,15,14,19,2,15,146,3,1,15,10,19,2,12,62,9,12,160,3,3,104,48,15,196,35,24,15,2,18,5,9,16,19,7,144,3,15,102,13,6,12,244,34,6,98,22,7,169,21,15,184,35,27,16,0,208,
+    38,22,4,108,10,6,86,5,6,76,0,0,138,85,15,20,53,41,0,64,82,15,254,57,6,12,74,7,8,164,4,8,100,2,15,40,0,5,15,68,3,5,2,223,0,2,30,3,8,99,7,1,41,1,7,8,0,5,25,0,6,108,3,15,29,53,42,0,1,
+    0,0,56,76,47,1,128,40,56,8,4,18,2,13,54,9,15,246,1,7,0,88,0,7,249,13,15,164,0,9,4,208,65,15,196,66,10,15,28,6,9,5,244,10,3,117,0,13,209,24,15,218,65,9,18,7,36,57,14,156,11,12,2,2,8,
+    138,3,7,66,0,15,149,3,0,47,0,30,128,2,46,0,192,84,15,132,2,14,4,162,9,15,144,26,5,15,32,0,13,15,140,2,20,5,102,22,2,1,0,15,18,0,2,15,142,2,56,0,1,0,2,4,43,31,4,4,86,1,15,52,13,17,12,
+    119,15,2,104,23,32,128,2,228,2,15,224,36,4,15,244,6,5,4,210,2,12,252,80,15,183,4,2,7,144,76,15,136,7,12,15,46,21,18,15,222,10,1,13,50,21,4,141,76,15,71,5,4,8,15,6,0,104,3,31,2,124,
+    37,7,8,112,2,9,166,12,12,164,0,4,89,0,5,47,11,15,196,5,7,1,220,3,15,116,0,29,15,106,4,1,7,241,0,15,54,6,11,0,132,1,18,2,82,25,8,36,6,0,76,0,2,40,38,5,246,44,0,120,12,47,0,255,100,13,
+    21,15,192,28,18,12,110,3,8,250,5,0,4,0,15,184,28,7,8,20,33,31,253,18,14,2,15,1,0,8,2,8,60,15,76,56,25,15,36,70,10,8,136,2,4,12,0,12,128,11,8,16,0,15,156,5,17,5,164,5,3,32,10,7,179,
+    11,4,193,11,6,207,2,11,5,0,15,83,4,43,64,0,0,0,9,220,93,0,254,3,15,28,1,0,13,238,8,15,12,0,1,11,78,25,15,106,27,0,1,105,0,64,4,1,128,254,102,0,7,152,17,4,70,0,10,152,26,11,209,72,0,
+    156,4,15,124,41,8,8,68,0,12,52,4,22,1,111,20,15,23,82,8,2,128,33,15,136,3,9,15,4,5,9,15,12,5,10,15,18,5,11,2,126,0,15,224,7,12,4,64,36,15,60,2,13,5,229,0,6,246,13,15,226,31,12,79,0,
+    0,0,22,52,22,32,30,87,44,25,15,72,12,1,4,140,1,12,242,3,8,12,0,12,184,7,0,41,7,10,2,42,9,88,25,8,70,72,1,1,0,2,130,12,15,220,91,36,0,24,4,15,0,1,76,15,152,8,1,15,96,24,9,15,0,1,9,8,
+    151,39,5,247,54,3,45,20,15,2,1,38,3,32,65,15,76,94,36,9,128,3,12,68,14,12,8,5,12,20,0,15,24,2,29,2,5,64,6,216,2,1,87,3,2,10,0,15,27,2,62,4,1,0,15,216,76,17,4,140,14,4,198,6,0,12,0,
+    13,246,11,2,79,0,4,19,8,8,39,70,15,156,18,6,4,252,55,15,156,1,20,6,188,52,15,176,9,12,15,148,2,13,15,188,75,25,3,95,1,15,7,20,16,2,211,0,15,212,0,32,1,152,0,0,100,1,15,212,0,41,5,4,
+    47,15,213,0,65,3,208,63,15,68,3,24,13,80,6,15,180,1,49,3,219,0,15,229,0,27,15,233,0,26,6,188,64,15,236,0,29,9,228,8,15,236,0,48,6,195,14,15,236,0,72,4,124,59,15,24,18,24,15,204,1,50,
+    5,52,8,15,220,0,18,4,1,5,15,215,0,19,15,240,6,40,15,212,0,9,15,184,2,48,15,246,0,27,15,239,0,19,13,255,0,0,120,29,15,124,16,34,15,140,46,2,12,134,9,4,202,7,15,254,0,21,10,30,6,7,161,
+    23,2,214,7,2,202,6,14,16,13,15,243,11,38,2,76,26,0,60,102,15,100,86,43,12,6,40,12,242,1,4,36,0,0,8,0,15,70,80,10,4,175,10,15,67,69,30,4,192,93,15,136,4,28,9,32,7,12,162,1,4,214,0,15,
+    24,0,17,1,182,1,6,12,42,15,127,79,2,15,71,6,28,2,218,0,15,216,0,35,2,106,1,15,216,0,52,2,44,7,15,218,0,62,4,160,34,15,220,0,25,7,124,101,8,58,6,15,186,1,46,15,26,27,0,15,228,0,4,15,
+    192,1,36,15,16,60,22,7,32,7,15,152,2,57,15,219,0,11,15,51,6,26,2,216,0,1,220,49,31,2,56,6,11,15,98,3,2,11,48,4,14,162,15,13,215,27,4,171,15,7,12,0,15,153,0,7,15,152,0,21,13,34,3,15,
+    152,0,13,2,6,3,6,80,15,15,154,0,30,63,0,0,14,156,0,16,7,120,40,12,4,2,15,58,1,16,6,62,65,15,164,0,4,15,64,1,21,15,156,31,23,15,158,0,22,15,155,0,7,15,127,2,16,5,224,33,15,72,3,23,7,
+    224,33,8,164,0,15,150,8,9,15,202,17,9,4,4,0,1,143,0,8,12,75,5,225,23,15,59,86,0,15,83,3,24,3,232,0,31,25,144,9,34,2,128,15,15,90,11,6,8,90,15,15,12,0,1,0,8,0,8,180,8,15,192,8,1,4,12,
+    0,10,54,26,4,198,7,15,134,79,22,15,123,11,32,7,30,1,4,108,32,15,32,1,17,15,0,15,18,15,242,1,9,10,248,14,15,252,77,0,5,96,13,15,0,7,24,6,48,33,15,196,0,21,1,144,0,15,240,14,9,15,196,
+    0,9,11,232,14,15,197,0,55,15,184,15,32,8,192,0,15,148,1,41,12,216,14,15,213,0,16,15,217,0,23,15,216,0,32,15,204,14,21,15,216,0,13,12,196,14,15,216,0,58,4,140,75,15,24,40,20,15,164,
+    1,42,11,186,13,15,200,0,10,15,123,8,22,0,152,24,15,44,107,9,15,194,55,1,8,12,0,0,28,0,9,105,12,4,242,9,15,188,55,8,6,16,22,15,32,14,28,5,240,2,12,220,20,15,106,5,5,15,154,5,9,4,20,
+    0,5,40,2,9,242,21,9,105,5,10,137,5,7,38,27,15,33,14,34,7,244,16,15,116,20,33,15,52,2,21,15,102,7,1,1,232,3,15,83,80,22,15,118,20,30,15,120,20,38,15,216,0,45,5,76,13,15,218,0,69,15,
+    124,20,52,15,188,1,46,15,48,85,11,15,232,0,5,15,236,0,27,15,144,19,40,15,224,0,42,4,206,106,15,220,0,21,15,146,19,27,5,32,43,15,196,12,23,15,182,0,5,4,94,4,4,144,11,3,126,2,4,170,34,
+    15,33,43,3,2,135,0,15,205,12,13,15,244,41,24,8,8,70,15,142,11,25,4,186,0,5,118,0,14,72,99,12,178,47,15,1,0,11,0,87,1,18,25,44,78,15,144,15,24,11,96,11,15,190,0,25,15,86,2,25,4,52,0,
+    15,6,112,4,15,176,98,8,0,1,0,31,253,242,114,17,15,27,1,9,15,244,40,31,12,218,15,15,224,78,35,5,147,35,14,181,76,9,169,76,15,63,3,20,15,188,41,33,4,70,3,15,200,0,41,7,30,16,15,202,0,
+    53,15,76,78,36,4,248,3,15,154,1,48,6,78,16,15,212,0,13,15,214,0,23,15,16,19,40,15,218,0,56,8,14,67,15,220,0,15,15,180,1,25,15,164,112,28,15,74,17,0,15,40,82,39,15,207,0,11,2,39,5,15,
+    168,1,28,15,120,22,33,4,172,1,15,130,2,53,15,89,3,15,7,185,0,15,224,0,21,31,22,48,52,32,31,87,50,52,7,15,206,5,1,15,228,0,1,15,44,0,5,2,150,0,3,54,9,3,195,0,15,50,52,52,2,248,6,31,
+    15,128,68,20,15,228,25,14,12,194,0,4,28,0,14,188,6,0,1,0,12,217,25,15,190,0,21,15,144,6,48,15,106,7,14,15,152,33,2,22,0,11,24,15,124,82,4,15,199,5,30,15,148,6,37,4,244,17,15,204,0,
+    38,5,165,0,15,205,0,56,15,148,6,53,15,210,0,42,5,21,29,15,213,0,10,15,164,1,34,15,184,5,39,15,112,2,38,15,207,0,13,15,185,5,27,2,192,41,15,228,80,6,13,42,3,12,180,23,1,74,45,4,6,3,
+    5,1,0,15,40,2,9,15,112,0,14,9,206,2,15,112,0,2,14,90,0,15,113,0,10,5,200,81,15,160,41,10,12,118,2,15,122,0,9,10,246,67,15,65,2,11,3,240,0,15,124,0,3,13,26,2,15,96,1,5,15,115,0,2,15,
+    125,68,1,15,52,9,38,4,168,6,0,8,1,4,12,1,12,150,25,15,136,7,5,15,168,2,2,6,138,7,15,139,7,0,15,164,52,38,1,227,0,15,36,5,33,15,20,10,4,15,212,0,14,8,8,0,6,28,29,5,61,9,15,35,86,19,
+    15,143,3,16,15,140,61,28,15,192,6,10,15,160,1,17,10,184,6,15,153,1,8,15,188,0,63,12,240,9,15,188,0,26,7,60,13,15,190,0,53,15,36,61,32,15,164,6,13,15,130,1,14,15,156,6,2,15,31,3,10,
+    15,202,0,17,15,24,3,56,15,206,0,28,8,24,3,15,208,0,19,15,156,1,21,15,48,60,28,15,200,0,42,15,195,0,19,15,99,7,22,1,0,55,15,72,11,1,1,170,0,12,134,4,1,130,0,2,78,1,6,132,52,0,3,11,8,
+    106,0,0,12,0,1,184,21,15,20,62,24,9,112,13,12,24,1,4,12,0,0,56,1,8,12,2,8,124,45,15,198,11,1,22,2,216,29,6,110,38,8,7,0,5,131,89,15,36,62,28,1,57,1,7,248,1,15,16,5,28,15,200,5,17,12,
+    212,6,4,120,49,15,204,5,7,15,148,17,29,15,192,0,30,5,20,5,15,192,0,34,4,109,7,15,194,0,57,15,20,5,42,15,198,0,39,15,86,7,13,15,74,18,31,15,68,4,39,15,76,2,37,15,195,0,18,15,70,4,23,
+    5,244,95,15,136,22,26,15,86,2,46,15,216,36,7,15,44,3,17,0,1,0,15,53,14,32,6,246,0,0,228,4,15,100,135,28,15,60,24,25,15,250,0,9,0,16,0,15,76,24,9,15,88,24,42,7,227,0,5,216,1,15,212,
+    40,30,15,162,2,41,15,112,37,7,15,182,2,16,11,240,0,15,214,1,30,1,202,41,20,1,140,152,64,0,0,36,0,126,153,0,1,0,83,1,0,26,0,130,12,0,83,2,0,14,0,108,12,0,23,3,24,0,23,4,12,0,18,5,150,
+    67,1,1,0,17,6,24,0,4,252,149,51,18,0,20,12,0,83,1,0,13,0,49,12,0,83,2,0,7,0,38,12,0,83,3,0,17,0,45,12,0,23,4,36,0,83,5,0,10,0,62,12,0,17,6,24,0,49,3,0,1,204,152,0,168,0,2,12,0,2,168,
+    0,2,12,0,2,168,0,2,12,0,83,3,0,34,0,122,12,0,2,168,0,2,12,0,2,168,0,2,12,0,2,168,0,147,50,0,48,0,48,0,52,0,47,6,0,241,64,49,0,53,98,121,32,84,114,105,115,116,97,110,32,71,114,105,109,
+    109,101,114,82,101,103,117,108,97,114,84,84,88,32,80,114,111,103,103,121,67,108,101,97,110,84,84,50,48,48,52,47,48,52,47,49,53,0,98,0,121,0,32,0,84,0,114,0,105,0,115,0,116,0,97,0,110,
+    0,32,0,71,16,0,241,32,109,0,109,0,101,0,114,0,82,0,101,0,103,0,117,0,108,0,97,0,114,0,84,0,84,0,88,0,32,0,80,0,114,0,111,0,103,0,103,0,121,0,67,0,108,0,101,60,0,0,30,0,0,40,1,4,1,0,
+    0,184,0,12,28,154,0,24,154,0,5,0,241,46,2,1,3,1,4,1,5,1,6,1,7,1,8,1,9,1,10,1,11,1,12,1,13,1,14,1,15,1,16,1,17,1,18,1,19,1,20,1,21,1,22,1,23,1,24,1,25,1,26,1,27,1,28,1,29,1,30,1,31,
+    1,32,215,3,241,68,5,0,6,0,7,0,8,0,9,0,10,0,11,0,12,0,13,0,14,0,15,0,16,0,17,0,18,0,19,0,20,0,21,0,22,0,23,0,24,0,25,0,26,0,27,0,28,0,29,0,30,0,31,0,32,0,33,0,34,0,35,0,36,0,37,0,38,
+    0,39,0,40,0,41,0,42,0,43,0,44,0,45,0,46,82,1,250,255,100,49,0,50,0,51,0,52,0,53,0,54,0,55,0,56,0,57,0,58,0,59,0,60,0,61,0,62,0,63,0,64,0,65,0,66,0,67,0,68,0,69,0,70,0,71,0,72,0,73,
+    0,74,0,75,0,76,0,77,0,78,0,79,0,80,0,81,0,82,0,83,0,84,0,85,0,86,0,87,0,88,0,89,0,90,0,91,0,92,0,93,0,94,0,95,0,96,0,97,1,33,1,34,1,35,1,36,1,37,1,38,1,39,1,40,1,41,1,42,1,43,1,44,
+    1,45,1,46,1,47,1,48,1,49,1,50,1,51,1,52,1,53,1,54,1,55,1,56,1,57,1,58,1,59,1,60,1,61,1,62,1,63,1,64,1,65,0,172,0,163,0,132,0,133,0,189,0,150,0,232,0,134,0,142,0,139,0,157,0,169,0,164,
+    0,239,0,138,0,218,0,131,0,147,0,242,0,243,0,141,0,151,0,136,0,195,0,222,0,241,0,158,0,170,0,245,0,244,0,246,0,162,0,173,0,201,0,199,0,174,0,98,0,99,0,144,0,100,0,203,0,101,0,200,0,
+    202,0,207,0,204,0,205,0,206,0,233,0,102,0,211,0,208,0,209,0,175,0,103,0,240,0,145,0,214,0,212,0,213,0,104,0,235,0,237,0,137,0,106,0,105,0,107,0,109,0,108,0,110,0,160,0,111,0,113,0,
+    112,0,114,0,115,0,117,0,116,0,118,0,119,0,234,0,120,0,122,0,121,0,123,0,125,0,124,0,184,0,161,0,127,0,126,0,128,0,129,0,236,0,238,0,186,14,117,110,105,99,111,100,101,35,48,120,48,48,
+    48,49,15,0,26,50,15,0,26,51,15,0,26,52,15,0,26,53,15,0,26,54,15,0,26,55,15,0,26,56,15,0,26,57,15,0,26,97,15,0,26,98,15,0,26,99,15,0,26,100,15,0,26,101,15,0,25,102,15,0,42,49,48,15,
+    0,10,240,0,26,49,240,0,26,49,240,0,26,49,240,0,26,49,240,0,26,49,240,0,26,49,240,0,26,49,240,0,26,49,240,0,26,49,240,0,26,49,240,0,26,49,240,0,26,49,240,0,26,49,240,0,233,49,102,6,
+    100,101,108,101,116,101,4,69,117,114,111,27,0,26,56,237,0,26,56,237,0,26,56,237,0,26,56,237,0,26,56,237,0,26,56,237,0,26,56,237,0,26,56,237,0,26,56,237,0,26,56,237,0,26,56,237,0,26,
+    56,237,0,26,56,237,0,26,56,237,0,26,56,221,1,26,57,221,1,26,57,240,0,26,57,240,0,26,57,240,0,26,57,240,0,26,57,240,0,26,57,240,0,26,57,240,0,26,57,240,0,26,57,240,0,26,57,240,0,26,
+    57,240,0,26,57,240,0,26,57,240,0,25,57,240,0,80,48,57,102,0,0,
+};
+
@@ -2,7 +2,8 @@
 // (binary_to_compressed_c.cpp)
 // Helper tool to turn a file into a C array, if you want to embed font data in your source code.
 
-// The data is first compressed with stb_compress() to reduce source code size.
+// The data is first compressed with stb_compress() to reduce source code size,
+// or with -lz4 into an LZ4 style block that decompresses several times faster.
 // Then stored in a C array:
 // - Base85:   ~5 bytes of source code for 4 bytes of input data. 5 bytes stored in binary (suggested by @mmalex).
 // - As int:  ~11 bytes of source code for 4 bytes of input data. 4 bytes stored in binary. Endianness dependant, need swapping on big-endian CPU.
@@ -16,10 +17,16 @@
 // You can also find a precompiled Windows binary in the binary/demo package available from https://github.com/ocornut/imgui
 
 // Usage:
-//   binary_to_compressed_c.exe [-nocompress] [-nostatic] [-base85] <inputfile> <symbolname>
+//   binary_to_compressed_c.exe [-nocompress] [-nostatic] [-base85] [-lz4] [-chain N] <inputfile> <symbolname>
 // Usage example:
 //   # binary_to_compressed_c.exe myfont.ttf MyFont > myfont.cpp
 //   # binary_to_compressed_c.exe -base85 myfont.ttf MyFont > myfont.cpp
+//   # binary_to_compressed_c.exe -lz4 myfont.ttf MyFont > myfont.cpp
+// LZ4 output:
+//   "LZ4B", the decompressed size as 4 bytes little-endian, then one LZ4 block
+//   (token, literals, 2 byte offset, extra match length; the last sequence has
+//   literals only). -chain caps how many earlier positions with the same hash are
+//   tried per byte (64 by default), trading ratio for compression speed.
 // Note:
 //   Base85 encoding will be obsoleted by future version of Dear ImGui!
 
@@ -28,12 +35,22 @@
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BINARY_TO_C_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 // stb_compress* from stb.h - declaration
 typedef unsigned int stb_uint;
 typedef unsigned char stb_uchar;
 stb_uint stb_compress(stb_uchar* out, stb_uchar* in, stb_uint len);
 
+// LZ4 style block, see above
+int lz4_compress(const unsigned char* in, int len, unsigned char* out, int max_chain);
+
 enum SourceEncoding
 {
     SourceEncoding_U8,      // New default since 2024/11
@@ -41,22 +58,34 @@ enum SourceEncoding
     SourceEncoding_Base85,
 };
 
-static bool binary_to_compressed_c(const char* filename, const char* symbol, SourceEncoding source_encoding, bool use_compression, bool use_static);
+enum Compression
+{
+    Compression_None,
+    Compression_Stb,
+    Compression_Lz4,
+};
+
+static bool binary_to_compressed_c(const char* filename, const char* symbol, SourceEncoding source_encoding, Compression compression, int max_chain, bool use_static);
 
 int main(int argc, char** argv)
 {
     if (argc < 3)
     {
-        printf("Syntax: %s [-u8|-u32|-base85] [-nocompress] [-nostatic] <inputfile> <symbolname>\n", argv[0]);
+        printf("Syntax: %s [-u8|-u32|-base85] [-nocompress|-lz4] [-chain N] [-nostatic] <inputfile> <symbolname>\n", argv[0]);
         printf("Source encoding types:\n");
         printf(" -u8     = ~12 bytes of source per 4 bytes of data. 4 bytes in binary.\n");
         printf(" -u32    = ~11 bytes of source per 4 bytes of data. 4 bytes in binary. Need endianness swapping on big-endian.\n");
         printf(" -base85 =  ~5 bytes of source per 4 bytes of data. 5 bytes in binary. Need decoder.\n");
+        printf("Compression:\n");
+        printf(" default = stb_compress(), for AddFontFromMemoryCompressedTTF().\n");
+        printf(" -lz4    = LZ4 style block, larger but much faster to decompress. Needs its own decoder.\n");
+        printf(" -chain  = most earlier matches tried per position with -lz4 (default 64).\n");
         return 0;
     }
 
     int argn = 1;
-    bool use_compression = true;
+    Compression compression = Compression_Stb;
+    int max_chain = 64;
     bool use_static = true;
     SourceEncoding source_encoding = SourceEncoding_U8; // New default
     while (argn < (argc - 2) && argv[argn][0] == '-')
@@ -64,7 +93,9 @@ int main(int argc, char** argv)
         if (strcmp(argv[argn], "-u8") == 0) { source_encoding = SourceEncoding_U8; argn++; }
         else if (strcmp(argv[argn], "-u32") == 0) { source_encoding = SourceEncoding_U32; argn++; }
         else if (strcmp(argv[argn], "-base85") == 0) { source_encoding = SourceEncoding_Base85; argn++; }
-        else if (strcmp(argv[argn], "-nocompress") == 0) { use_compression = false; argn++; }
+        else if (strcmp(argv[argn], "-nocompress") == 0) { compression = Compression_None; argn++; }
+        else if (strcmp(argv[argn], "-lz4") == 0) { compression = Compression_Lz4; argn++; }
+        else if (strcmp(argv[argn], "-chain") == 0 && argn + 1 < argc - 2) { max_chain = atoi(argv[argn + 1]); if (max_chain < 1) max_chain = 1; argn += 2; }
         else if (strcmp(argv[argn], "-nostatic") == 0) { use_static = false; argn++; }
         else
         {
@@ -73,7 +104,7 @@ int main(int argc, char** argv)
         }
     }
 
-    bool ret = binary_to_compressed_c(argv[argn], argv[argn + 1], source_encoding, use_compression, use_static);
+    bool ret = binary_to_compressed_c(argv[argn], argv[argn + 1], source_encoding, compression, max_chain, use_static);
     if (!ret)
         fprintf(stderr, "Error opening or reading file: '%s'\n", argv[argn]);
     return ret ? 0 : 1;
@@ -85,8 +116,9 @@ char Encode85Byte(unsigned int x)
     return (char)((x >= '\\') ? x + 1 : x);
 }
 
-bool binary_to_compressed_c(const char* filename, const char* symbol, SourceEncoding source_encoding, bool use_compression, bool use_static)
+bool binary_to_compressed_c(const char* filename, const char* symbol, SourceEncoding source_encoding, Compression compression, int max_chain, bool use_static)
 {
+    bool use_compression = compression != Compression_None;
     // Read file
     FILE* f = fopen(filename, "rb");
     if (!f) return false;
@@ -100,7 +132,11 @@ bool binary_to_compressed_c(const char* filename, const char* symbol, SourceEnco
     // Compress
     int maxlen = data_sz + 512 + (data_sz >> 2) + sizeof(int); // total guess
     char* compressed = use_compression ? new char[maxlen] : data;
-    int compressed_sz = use_compression ? stb_compress((stb_uchar*)compressed, (stb_uchar*)data, data_sz) : data_sz;
+    int compressed_sz = data_sz;
+    if (compression == Compression_Stb)
+        compressed_sz = stb_compress((stb_uchar*)compressed, (stb_uchar*)data, data_sz);
+    else if (compression == Compression_Lz4)
+        compressed_sz = lz4_compress((unsigned char*)data, data_sz, (unsigned char*)compressed, max_chain);
     if (use_compression)
         memset(compressed + compressed_sz, 0, maxlen - compressed_sz);
 
@@ -108,10 +144,11 @@ bool binary_to_compressed_c(const char* filename, const char* symbol, SourceEnco
     FILE* out = stdout;
     fprintf(out, "// File: '%s' (%d bytes)\n", filename, (int)data_sz);
     const char* static_str = use_static ? "static " : "";
-    const char* compressed_str = use_compression ? "compressed_" : "";
+    const char* compressed_str = compression == Compression_Lz4 ? "lz4_" : use_compression ? "compressed_" : "";
+    const char* option_str = compression == Compression_Lz4 ? "-lz4 " : "";
     if (source_encoding == SourceEncoding_Base85)
     {
-        fprintf(out, "// Exported using binary_to_compressed_c.exe -base85 \"%s\" %s\n", filename, symbol);
+        fprintf(out, "// Exported using binary_to_compressed_c.exe -base85 %s\"%s\" %s\n", option_str, filename, symbol);
         fprintf(out, "%sconst char %s_%sdata_base85[%d+1] =\n    \"", static_str, symbol, compressed_str, (int)((compressed_sz + 3) / 4)*5);
         char prev_c = 0;
         for (int src_i = 0; src_i < compressed_sz; src_i += 4)
@@ -121,7 +158,9 @@ bool binary_to_compressed_c(const char* filename, const char* symbol, SourceEnco
             for (unsigned int n5 = 0; n5 < 5; n5++, d /= 85)
             {
                 char c = Encode85Byte(d);
-                fprintf(out, (c == '?' && prev_c == '?') ? "\\%c" : "%c", c);
+                if (c == '?' && prev_c == '?')
+                    putc('\\', out);
+                putc(c, out);
                 prev_c = c;
             }
             if ((src_i % 112) == 112 - 4)
@@ -132,25 +171,37 @@ bool binary_to_compressed_c(const char* filename, const char* symbol, SourceEnco
     else if (source_encoding == SourceEncoding_U8)
     {
         // As individual bytes, not subject to endianness issues.
-        fprintf(out, "// Exported using binary_to_compressed_c.exe -u8 \"%s\" %s\n", filename, symbol);
+        fprintf(out, "// Exported using binary_to_compressed_c.exe -u8 %s\"%s\" %s\n", option_str, filename, symbol);
         fprintf(out, "%sconst unsigned int %s_%ssize = %d;\n", static_str, symbol, compressed_str, (int)compressed_sz);
         fprintf(out, "%sconst unsigned char %s_%sdata[%d] =\n{", static_str, symbol, compressed_str, (int)compressed_sz);
+        // Formatted by hand into whole lines, fprintf per byte took longer than compressing
+        char line[256];
         int column = 0;
         for (int i = 0; i < compressed_sz; i++)
         {
             unsigned char d = *(unsigned char*)(compressed + i);
             if (column == 0)
-                fprintf(out, "\n    ");
-            column += fprintf(out, "%d,", d);
-            if (column >= 180)
+            {
+                memcpy(line, "\n    ", 5);
+                column = 5;
+            }
+            if (d >= 100) line[column++] = (char)('0' + d / 100);
+            if (d >= 10)  line[column++] = (char)('0' + d / 10 % 10);
+            line[column++] = (char)('0' + d % 10);
+            line[column++] = ',';
+            if (column - 5 >= 180)
+            {
+                fwrite(line, 1, column, out);
                 column = 0;
+            }
         }
+        fwrite(line, 1, column, out);
         fprintf(out, "\n};\n\n");
     }
     else if (source_encoding == SourceEncoding_U32)
     {
         // As integers
-        fprintf(out, "// Exported using binary_to_compressed_c.exe -u32 \"%s\" %s\n", filename, symbol);
+        fprintf(out, "// Exported using binary_to_compressed_c.exe -u32 %s\"%s\" %s\n", option_str, filename, symbol);
         fprintf(out, "%sconst unsigned int %s_%ssize = %d;\n", static_str, symbol, compressed_str, (int)compressed_sz);
         fprintf(out, "%sconst unsigned int %s_%sdata[%d/4] =\n{", static_str, symbol, compressed_str, (int)((compressed_sz + 3) / 4)*4);
         int column = 0;
@@ -207,10 +258,30 @@ static stb_uint stb_adler32(stb_uint adler32, stb_uchar *buffer, stb_uint buflen
     return (s2 << 16) + s1;
 }
 
-static unsigned int stb_matchlen(stb_uchar *m1, stb_uchar *m2, stb_uint maxlen)
+static inline unsigned int count_trailing_zeros(unsigned int mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned int)index;
+#else
+    return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+// Compares 16 bytes at a time where SSE2 is there, the result is the same as a byte loop
+static unsigned int stb_matchlen(const stb_uchar *m1, const stb_uchar *m2, stb_uint maxlen)
 {
-    stb_uint i;
-    for (i=0; i < maxlen; ++i)
+    stb_uint i = 0;
+#ifdef BINARY_TO_C_SSE2
+    for (; i + 16 <= maxlen; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(m1 + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(m2 + i));
+        unsigned int differ = ~(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) & 0xFFFF;
+        if (differ) return i + count_trailing_zeros(differ);
+    }
+#endif
+    for (; i < maxlen; ++i)
         if (m1[i] != m2[i]) return i;
     return i;
 }
@@ -422,3 +493,116 @@ stb_uint stb_compress(stb_uchar *out, stb_uchar *input, stb_uint length)
 
     return (stb_uint)(stb__out - out);
 }
+
+////////////////////           LZ4 style block    ///////////////////////
+
+// Greedy parse over a hash of the next 4 bytes. Every position is chained to the
+// previous one with the same hash, up to 64K back (the longest offset), and
+// max_chain of them are tried. out needs room for len + len / 255 + 16 bytes.
+
+#define LZ4_MIN_MATCH     4
+#define LZ4_LAST_LITERALS 5     // the last 5 bytes are always literals
+#define LZ4_MATCH_LIMIT   12    // no match starts in the last 12 bytes
+#define LZ4_WINDOW        65536
+#define LZ4_HASH_LOG      16
+
+static inline stb_uint lz4_read32(const unsigned char* p)
+{
+    stb_uint v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline stb_uint lz4_hash(const unsigned char* p)
+{
+    return (lz4_read32(p) * 2654435761u) >> (32 - LZ4_HASH_LOG);
+}
+
+static unsigned char* lz4_out_length(unsigned char* op, int length)
+{
+    for (; length >= 255; length -= 255)
+        *op++ = 255;
+    *op++ = (unsigned char)length;
+    return op;
+}
+
+static unsigned char* lz4_out_sequence(unsigned char* op, const unsigned char* literals, int literal_len, int offset, int match_len)
+{
+    unsigned char* token = op++;
+    *token = (unsigned char)((literal_len < 15 ? literal_len : 15) << 4);
+    if (literal_len >= 15)
+        op = lz4_out_length(op, literal_len - 15);
+    memcpy(op, literals, literal_len);
+    op += literal_len;
+    if (match_len == 0) // last sequence
+        return op;
+    *op++ = (unsigned char)offset;
+    *op++ = (unsigned char)(offset >> 8);
+    int extra = match_len - LZ4_MIN_MATCH;
+    *token |= (unsigned char)(extra < 15 ? extra : 15);
+    if (extra >= 15)
+        op = lz4_out_length(op, extra - 15);
+    return op;
+}
+
+int lz4_compress(const unsigned char* in, int len, unsigned char* out, int max_chain)
+{
+    unsigned char* op = out;
+    memcpy(op, "LZ4B", 4);
+    op[4] = (unsigned char)len; op[5] = (unsigned char)(len >> 8); op[6] = (unsigned char)(len >> 16); op[7] = (unsigned char)(len >> 24);
+    op += 8;
+
+    int* head = (int*)malloc(sizeof(int) << LZ4_HASH_LOG);
+    int* chain = (int*)malloc(sizeof(int) * LZ4_WINDOW);
+    if (!head || !chain) { free(head); free(chain); return 0; }
+    for (int h = 0; h < (1 << LZ4_HASH_LOG); h++)
+        head[h] = -1;
+
+    int anchor = 0;
+    int pos = 0;
+    int inserted = 0;   // positions below this are in the chains
+    const int match_end = len - LZ4_LAST_LITERALS;
+    while (pos + LZ4_MATCH_LIMIT <= len)
+    {
+        for (; inserted <= pos; inserted++)
+        {
+            stb_uint h = lz4_hash(in + inserted);
+            chain[inserted & (LZ4_WINDOW - 1)] = head[h];
+            head[h] = inserted;
+        }
+
+        int best_len = 0, best_offset = 0;
+        stb_uint here = lz4_read32(in + pos);
+        int candidate = chain[pos & (LZ4_WINDOW - 1)];
+        for (int tries = 0; candidate >= 0 && pos - candidate < LZ4_WINDOW && tries < max_chain; tries++)
+        {
+            if (lz4_read32(in + candidate) == here && in[candidate + best_len] == in[pos + best_len])
+            {
+                int match_len = LZ4_MIN_MATCH + (int)stb_matchlen(in + candidate + LZ4_MIN_MATCH, in + pos + LZ4_MIN_MATCH, (stb_uint)(match_end - pos - LZ4_MIN_MATCH));
+                if (match_len > best_len)
+                {
+                    best_len = match_len;
+                    best_offset = pos - candidate;
+                }
+            }
+            int next = chain[candidate & (LZ4_WINDOW - 1)];
+            if (next >= candidate) // the slot was reused by a newer position
+                break;
+            candidate = next;
+        }
+
+        if (best_len < LZ4_MIN_MATCH)
+        {
+            pos++;
+            continue;
+        }
+        op = lz4_out_sequence(op, in + anchor, pos - anchor, best_offset, best_len);
+        pos += best_len;
+        anchor = pos;
+    }
+    op = lz4_out_sequence(op, in + anchor, len - anchor, 0, 0);
+
+    free(head);
+    free(chain);
+    return (int)(op - out);
+}
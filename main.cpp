@@ -17,18 +17,59 @@
 #include "imgui/backends/imgui_impl_sdl2.h"
 #include "imgui/backends/imgui_impl_sdlrenderer2.h"
 #include "imgui/implot/implot.h"
+#include "imgui/imgui_internal.h"   // ImFontLoader, atlas packing
+#include "fonts/ProggyClean.h"      // UI font as an LZ4 block
 #include <stdio.h>          // printf, fprintf
 #include <stdlib.h>         // abort
 #include <SDL.h>
 #include <SDL_syswm.h>
 #ifdef _WIN32
+#define NOMINMAX            // keep std::min/std::max usable
 #include <windows.h>        // SetProcessDPIAware()
+#else
+#include <sys/mman.h>       // mmap()
+#include <sys/stat.h>       // fstat()
+#include <fcntl.h>          // open()
+#include <unistd.h>         // close()
+#endif
+#ifdef __linux__
+#include <sched.h>          // sched_setaffinity()
+#include <sys/syscall.h>    // SYS_mbind, SYS_move_pages, SYS_perf_event_open
+#include <sys/ioctl.h>      // ioctl()
+#include <linux/perf_event.h> // dTLB miss counters
+#endif
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SORTIK_X86
+#include <immintrin.h>      // SSE2/AVX2/AVX-512 intrinsics
+#ifdef _MSC_VER
+#include <intrin.h>         // __cpuid(), _xgetbv()
+#endif
+#endif
+// GCC and Clang only emit AVX code in functions that ask for it, MSVC always can
+#if defined(SORTIK_X86) && !defined(_MSC_VER)
+#define SORTIK_TARGET_AVX2   __attribute__((target("avx2")))
+#define SORTIK_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define SORTIK_TARGET_AVX2
+#define SORTIK_TARGET_AVX512
 #endif
 
 #include <string>
 #include <random>
 #include <future>
 #include <thread>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <climits>
+#include <cerrno>
+#include <condition_variable>
+#include <memory>
+#include <type_traits>
 
 #define RENDER_WITH_TRANSPARENCY // Enable to make main window transparrent
 //#define DEVELOPER_OPTIONS        // Disable this for release
@@ -38,15 +79,855 @@
 //      FUNCTIONS
 //=================================================================================
 
+//---------------------------------------------------------------------------------
+//      TRACE
+//---------------------------------------------------------------------------------
+//
+// A trace file is a TraceHeader, the starting array (number * int32) and then
+// one record per array write: zigzag varint of (index - previous index)
+// followed by zigzag varint of (value - index), taken modulo 2^32 so any key
+// fits. Both are small for the way the engines walk Sortik's own arrays, so
+// most writes take 2-3 bytes.
+// A swap is recorded as two writes.
+
+struct TraceHeader
+{
+    char     magic[8];   // "SRTKTRC"
+    uint32_t version;
+    int32_t  number;
+    uint64_t operations; // patched in on close
+};
+
+class TraceRecorder
+{
+public:
+    bool open(const std::string& path, const int* array, int number)
+    {
+        file = fopen(path.c_str(), "wb");
+        if (!file)
+            return false;
+        file_path = path;
+        TraceHeader header = { "SRTKTRC", 1, number, 0 };
+        ok = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(array, sizeof(int), number, file) == (size_t)number;
+        buffer = new uint8_t[buffer_size];
+        used = 0;
+        operations = 0;
+        last_index = 0;
+        if (!ok)
+            close();
+        return file != nullptr;
+    }
+
+    inline void write(int index, int value)
+    {
+        if (used > buffer_size - 10)
+            flush();
+        put(zigzag(index - last_index));
+        put(zigzag((int)((uint32_t)value - (uint32_t)index)));
+        last_index = index;
+        operations++;
+    }
+
+    // False if any write failed, the partial file is removed then
+    bool close()
+    {
+        if (!file)
+            return true;
+        flush();
+        ok = ok && fseek(file, offsetof(TraceHeader, operations), SEEK_SET) == 0
+                && fwrite(&operations, sizeof(operations), 1, file) == 1;
+        ok = fclose(file) == 0 && ok;
+        if (!ok)
+            std::remove(file_path.c_str());
+        file = nullptr;
+        delete[] buffer;
+        buffer = nullptr;
+        return ok;
+    }
+
+    ~TraceRecorder() { close(); }
+
+private:
+    static const size_t buffer_size = 1 << 20;
+
+    FILE*    file = nullptr;
+    std::string file_path;
+    bool     ok = true;      // sticky, the first failed write spoils the trace
+    uint8_t* buffer = nullptr;
+    size_t   used = 0;
+    uint64_t operations = 0;
+    int      last_index = 0;
+
+    static inline uint32_t zigzag(int v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+
+    inline void put(uint32_t v)
+    {
+        while (v >= 0x80)
+        {
+            buffer[used++] = (uint8_t)v | 0x80;
+            v >>= 7;
+        }
+        buffer[used++] = (uint8_t)v;
+    }
+
+    void flush()
+    {
+        ok = ok && fwrite(buffer, 1, used, file) == used;
+        used = 0;
+    }
+};
+
+//---------------------------------------------------------------------------------
+//      DIRTY BLOCKS
+//---------------------------------------------------------------------------------
+//
+// Engines mark which blocks of the array they wrote to, so the renderer only
+// re-samples and re-uploads those. The bitmap has a fixed capacity and the
+// block size grows with the array, so resizing while a sort still runs can
+// only mislabel blocks, never write out of bounds.
+
+struct DirtySet
+{
+    static const int capacity = 1 << 14; // blocks
+    static const int words = capacity / 64;
+
+    int      shift = 0;                  // block = index >> shift
+    uint64_t bits[words] = {};
+
+    bool any(int begin, int end) const
+    {
+        if (end <= begin)
+            return false;
+        int first = std::min(begin >> shift, capacity - 1), last = std::min((end - 1) >> shift, capacity - 1);
+        for (int block = first; block <= last; block++)
+            if (bits[block >> 6] >> (block & 63) & 1)
+                return true;
+        return false;
+    }
+
+    bool empty() const
+    {
+        for (uint64_t word : bits)
+            if (word)
+                return false;
+        return true;
+    }
+};
+
+// Each consumer drains its own copy of the bitmap
+enum DirtyConsumer
+{
+    DirtyConsumer_Render,
+    DirtyConsumer_Metrics,
+    DirtyConsumer_Count,
+};
+
+class DirtyBlocks
+{
+public:
+    void reset(int number)
+    {
+        int new_shift = 0;
+        while (((long long)std::max(number - 1, 0) >> new_shift) >= DirtySet::capacity)
+            new_shift++;
+        shift = new_shift;
+        markAll();
+    }
+
+    inline void mark(int index)
+    {
+        int block = std::min(index >> shift.load(std::memory_order_relaxed), DirtySet::capacity - 1);
+        uint64_t bit = 1ull << (block & 63);
+        for (int consumer = 0; consumer < DirtyConsumer_Count; consumer++)
+        {
+            std::atomic<uint64_t>& word = bits[consumer][block >> 6];
+            // Most writes hit a block that is already dirty, skip the locked op then
+            if (!(word.load(std::memory_order_relaxed) & bit))
+                word.fetch_or(bit, std::memory_order_relaxed);
+        }
+    }
+
+    void markAll()
+    {
+        for (int consumer = 0; consumer < DirtyConsumer_Count; consumer++)
+            for (std::atomic<uint64_t>& word : bits[consumer])
+                word.store(~0ull, std::memory_order_relaxed);
+    }
+
+    // Takes everything marked since the consumer's previous call
+    void collect(DirtySet& out, DirtyConsumer consumer = DirtyConsumer_Render)
+    {
+        out.shift = shift.load(std::memory_order_relaxed);
+        for (int w = 0; w < DirtySet::words; w++)
+            out.bits[w] = bits[consumer][w].exchange(0, std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<int>      shift{ 0 };
+    std::atomic<uint64_t> bits[DirtyConsumer_Count][DirtySet::words] = {};
+};
+
+// Every sort runs on its own thread, so each one gets its own hooks
+thread_local TraceRecorder* trace_recorder = nullptr;
+thread_local DirtyBlocks*   dirty_blocks = nullptr;
+
+// Engines call this for every write into the array they sort
+inline void noteWrite(int index, int value)
+{
+    if (dirty_blocks)
+        dirty_blocks->mark(index);
+    if (trace_recorder)
+        trace_recorder->write(index, value);
+}
+
+// View of a whole file, so huge traces are paged in on demand. A copy-on-write
+// view can be written to: touched pages get private copies and the file stays
+// as it was. populate asks for the whole file to be read in up front, into the
+// page cache only for a copy-on-write view.
+class MappedFile
+{
+public:
+    bool open(const std::string& path, bool copy_on_write = false, bool populate = false)
+    {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER file_size;
+        HANDLE mapping = NULL;
+        if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+            mapping = CreateFileMappingA(file, NULL, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file);
+        if (!mapping)
+            return false;
+        data = (uint8_t*)MapViewOfFile(mapping, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping); // the view keeps the mapping alive
+        if (!data)
+            return false;
+        size = (size_t)file_size.QuadPart;
+    #if _WIN32_WINNT >= 0x0602
+        if (populate)
+        {
+            WIN32_MEMORY_RANGE_ENTRY range = { data, size };
+            PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+        }
+    #endif
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        void* view = MAP_FAILED;
+        int flags = MAP_PRIVATE;
+    #ifdef MAP_POPULATE
+        // On a writable private mapping it would fault every page in for write,
+        // copying the whole file before anything is sorted
+        if (populate && !copy_on_write)
+            flags |= MAP_POPULATE;
+    #endif
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+            view = mmap(nullptr, (size_t)info.st_size, copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ, flags, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED)
+            return false;
+        data = (uint8_t*)view;
+        size = (size_t)info.st_size;
+        // Without MAP_POPULATE, at least start the readahead now. It fills the page
+        // cache only, a private copy is still made on the first write to a page.
+        if (populate)
+            madvise(view, size, MADV_WILLNEED);
+#endif
+        return true;
+    }
+
+    void close()
+    {
+        if (!data)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+#else
+        munmap((void*)data, size);
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    ~MappedFile() { close(); }
+
+    uint8_t* data = nullptr;
+    size_t   size = 0;
+};
+
+// Plays a trace file back and forth. A full copy of the array is kept every
+// `interval` operations, so any position is at most `interval` decoded writes
+// away. Checkpoints are made lazily the first time playback passes them.
+class TraceReplay
+{
+public:
+    bool open(const std::string& path)
+    {
+        close();
+        if (!file.open(path))
+            return false;
+
+        TraceHeader header;
+        if (file.size < sizeof(header))
+            return fail();
+        memcpy(&header, file.data, sizeof(header));
+        if (memcmp(header.magic, "SRTKTRC", 8) != 0 || header.version != 1 || header.number <= 0
+            || file.size < sizeof(header) + (size_t)header.number * sizeof(int))
+            return fail();
+
+        number = header.number;
+        stream = file.data + sizeof(header) + (size_t)number * sizeof(int);
+        stream_end = file.data + file.size;
+        operations = header.operations;
+        if (operations == 0) // recorder didn't get to close, count records instead
+        {
+            for (const uint8_t* p = stream; p < stream_end; p++)
+                operations += !(*p & 0x80);
+            operations /= 2;
+        }
+
+        // Keep checkpoints under ~256 MB whatever the trace size
+        const uint64_t budget = 256ull << 20;
+        interval = std::max<uint64_t>(4096, operations * (uint64_t)number * sizeof(int) / budget);
+
+        array.resize(number);
+        memcpy(array.data(), file.data + sizeof(header), (size_t)number * sizeof(int));
+        cursor = stream;
+        last_index = 0;
+        position = 0;
+        checkpoints.push_back({ stream, 0, array });
+        dirty.reset(number);
+        return true;
+    }
+
+    void close()
+    {
+        file.close();
+        checkpoints.clear();
+        array.clear();
+        number = 0;
+        operations = 0;
+        position = 0;
+    }
+
+    bool isOpen() const { return file.data != nullptr; }
+
+    // Moves to the state right after `target` operations
+    void seek(uint64_t target)
+    {
+        target = std::min(target, operations);
+        size_t nearest = (size_t)std::min<uint64_t>(target / interval, checkpoints.size() - 1);
+        if (target < position || nearest * interval > position)
+            restore(nearest);
+        while (position < target && cursor < stream_end)
+            step();
+    }
+
+    int              number = 0;
+    uint64_t         operations = 0;
+    uint64_t         position = 0;
+    uint64_t         interval = 4096;
+    std::vector<int> array;
+    DirtyBlocks      dirty;
+
+private:
+    struct Checkpoint
+    {
+        const uint8_t*   cursor;
+        int              last_index;
+        std::vector<int> array;
+    };
+
+    MappedFile              file;
+    const uint8_t*          stream = nullptr;
+    const uint8_t*          stream_end = nullptr;
+    const uint8_t*          cursor = nullptr;
+    int                     last_index = 0;
+    std::vector<Checkpoint> checkpoints;
+
+    bool fail()
+    {
+        close();
+        return false;
+    }
+
+    inline uint32_t get()
+    {
+        uint32_t v = 0;
+        int shift = 0;
+        while (cursor < stream_end && (*cursor & 0x80))
+        {
+            v |= (uint32_t)(*cursor++ & 0x7f) << shift;
+            shift += 7;
+        }
+        if (cursor < stream_end)
+            v |= (uint32_t)*cursor++ << shift;
+        return v;
+    }
+
+    static inline int unzigzag(uint32_t v) { return (int)(v >> 1) ^ -(int)(v & 1); }
+
+    void step()
+    {
+        if (position == checkpoints.size() * interval)
+            checkpoints.push_back({ cursor, last_index, array });
+        int index = last_index + unzigzag(get());
+        int value = (int)((uint32_t)index + (uint32_t)unzigzag(get()));
+        if (index >= 0 && index < number)
+        {
+            array[index] = value;
+            dirty.mark(index);
+        }
+        last_index = index;
+        position++;
+    }
+
+    void restore(size_t c)
+    {
+        const Checkpoint& checkpoint = checkpoints[c];
+        cursor = checkpoint.cursor;
+        last_index = checkpoint.last_index;
+        array = checkpoint.array;
+        position = c * interval;
+        dirty.markAll();
+    }
+};
+
+//---------------------------------------------------------------------------------
+//      DATASETS
+//---------------------------------------------------------------------------------
+//
+// Key files for benchmarking real data. A file either starts with a
+// DatasetHeader or is nothing but little-endian int32 keys. Keys are used
+// where they lie in the mapping, so a dataset of any size opens in the time
+// it takes to map it, and the disk sets the pace when the pages come in.
+// Every platform Sortik builds for is little-endian, so there's no byte
+// swapping.
+
+enum DatasetType
+{
+    DatasetType_Int32,
+    DatasetType_UInt32,
+    DatasetType_Int64,
+    DatasetType_Float,
+    DatasetType_Count
+};
+
+const char* dataset_type_names[DatasetType_Count] = { "int32", "uint32", "int64", "float" };
+const size_t dataset_type_sizes[DatasetType_Count] = { 4, 4, 8, 4 };
+
+struct DatasetHeader
+{
+    char     magic[8];   // "SRTKDAT"
+    uint32_t version;
+    uint32_t type;       // DatasetType
+    uint64_t count;
+    uint64_t seed;       // what generated the keys, 0 for captured data
+};                       // 32 bytes, so 8-byte keys after it stay aligned
+
+class Dataset
+{
+public:
+    // copy_on_write lets an engine sort the keys in place without touching the file
+    bool open(const std::string& path, bool copy_on_write)
+    {
+        close();
+        if (!file.open(path, copy_on_write, true))
+            return false;
+        if (file.size >= sizeof(header) && memcmp(file.data, "SRTKDAT", 8) == 0)
+        {
+            memcpy(&header, file.data, sizeof(header));
+            if (header.version != 1 || header.type >= DatasetType_Count
+                || (file.size - sizeof(header)) / dataset_type_sizes[header.type] < header.count)
+            {
+                close();
+                return false;
+            }
+            keys = file.data + sizeof(header);
+        }
+        else
+        {
+            header = { "SRTKDAT", 1, DatasetType_Int32, file.size / sizeof(int32_t), 0 };
+            keys = file.data;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        file.close();
+        keys = nullptr;
+        header = {};
+    }
+
+    bool isOpen() const { return keys != nullptr; }
+
+    // The engines take int arrays, nullptr for other key types
+    int* ints() const { return header.type == DatasetType_Int32 ? (int*)keys : nullptr; }
+
+    DatasetHeader header = {};
+    uint8_t*      keys = nullptr;
+
+private:
+    MappedFile file;
+};
+
+bool saveDataset(const std::string& path, const int* keys, uint64_t count, uint64_t seed, bool raw = false)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    DatasetHeader header = { "SRTKDAT", 1, DatasetType_Int32, count, seed };
+    bool ok = raw || fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && fwrite(keys, sizeof(int), (size_t)count, file) == (size_t)count;
+    return fclose(file) == 0 && ok;
+}
+
+//---------------------------------------------------------------------------------
+//      KEY BUFFERS
+//---------------------------------------------------------------------------------
+//
+// Key arrays come from allocKeys() and go back through freeKeys(). By default that's
+// plain new[]. With a page or NUMA policy, arrays of 2 MB and up are mapped straight
+// from the OS on a 2 MB boundary so they can be backed by huge pages, interleaved
+// over the nodes or first touched by threads spread over every core.
+
+enum PagePolicy
+{
+    Pages_Default,
+    Pages_Transparent,  // madvise(MADV_HUGEPAGE)
+    Pages_Explicit,     // MAP_HUGETLB / MEM_LARGE_PAGES, needs pages reserved up front
+    Pages_Count
+};
+
+enum NumaPolicy
+{
+    Numa_Default,
+    Numa_Interleave,    // pages round-robin over the online nodes
+    Numa_Touch,         // zeroed in slices by one thread per core
+    Numa_Count
+};
+
+const char* page_policy_names[Pages_Count] = { "default", "thp", "hugetlb" };
+const char* numa_policy_names[Numa_Count]  = { "default", "interleave", "touch" };
+
+struct AllocPolicy
+{
+    int pages = Pages_Default;
+    int numa  = Numa_Default;
+};
+
+AllocPolicy alloc_policy;
+
+const size_t huge_page_bytes = (size_t)2 << 20;
+
+struct KeyMapping
+{
+    void*  base;
+    size_t bytes;
+};
+
+std::mutex key_mappings_mutex;
+std::vector<KeyMapping> key_mappings;  // only the OS mapped arrays, new[] ones aren't listed
+std::atomic<bool> huge_pages_warned(false);
+
+bool pinThreadToCore(int core);
+
+// Online NUMA nodes as a bit mask, 1 on machines without NUMA
+uint64_t onlineNodes()
+{
+    uint64_t mask = 0;
+#ifdef __linux__
+    FILE* file = fopen("/sys/devices/system/node/online", "r");
+    char list[256] = {};
+    if (file)
+    {
+        if (!fgets(list, sizeof(list), file))
+            list[0] = 0;
+        fclose(file);
+    }
+    for (const char* p = list; *p >= '0' && *p <= '9';)
+    {
+        char* end;
+        long first = strtol(p, &end, 10), last = first;
+        if (*end == '-')
+            last = strtol(end + 1, &end, 10);
+        for (long node = first; node <= last && node < 64; node++)
+            mask |= (uint64_t)1 << node;
+        p = *end == ',' ? end + 1 : end;
+    }
+#endif
+    return mask ? mask : 1;
+}
+
+// Each thread zeroes a contiguous slice, so first touch puts the slice on its node
+void touchInParallel(char* base, size_t bytes)
+{
+    int threads = std::max(1, (int)std::thread::hardware_concurrency());
+    size_t slice = ((bytes / threads) + huge_page_bytes - 1) & ~(huge_page_bytes - 1);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads && (size_t)t * slice < bytes; t++)
+        pool.emplace_back([=]()
+        {
+            pinThreadToCore(t);
+            size_t first = (size_t)t * slice;
+            memset(base + first, 0, std::min(slice, bytes - first));
+        });
+    for (std::thread& thread : pool)
+        thread.join();
+}
+
+void* mapKeys(size_t bytes)
+{
+#ifdef _WIN32
+    if (alloc_policy.pages == Pages_Explicit)
+    {
+        size_t large = GetLargePageMinimum();
+        if (large)
+        {
+            void* base = VirtualAlloc(nullptr, (bytes + large - 1) & ~(large - 1), MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (base)
+                return base;
+        }
+        if (!huge_pages_warned.exchange(true))
+            fprintf(stderr, "Warning: no large pages (needs SeLockMemoryPrivilege), using normal pages\n");
+    }
+    // No transparent huge pages or NUMA binding here, the touch policy still applies
+    return VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    #ifdef MAP_HUGETLB
+    if (alloc_policy.pages == Pages_Explicit)
+    {
+        void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED)
+            return base;
+        if (!huge_pages_warned.exchange(true))
+            fprintf(stderr, "Warning: no reserved huge pages (see /proc/sys/vm/nr_hugepages), using thp\n");
+    }
+    #endif
+    // Map an extra huge page and trim it off so the array starts on a 2 MB boundary
+    char* raw = (char*)mmap(nullptr, bytes + huge_page_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == (char*)MAP_FAILED)
+        return nullptr;
+    char* base = (char*)(((uintptr_t)raw + huge_page_bytes - 1) & ~(uintptr_t)(huge_page_bytes - 1));
+    if (base > raw)
+        munmap(raw, base - raw);
+    munmap(base + bytes, raw + huge_page_bytes - base);
+    #ifdef MADV_HUGEPAGE
+    if (alloc_policy.pages != Pages_Default)
+        madvise(base, bytes, MADV_HUGEPAGE);
+    #endif
+    #if defined(__linux__) && defined(SYS_mbind)
+    uint64_t nodes = onlineNodes();
+    if (alloc_policy.numa == Numa_Interleave && (nodes & (nodes - 1)))
+    {
+        const int mpol_interleave = 3;
+        syscall(SYS_mbind, base, bytes, mpol_interleave, &nodes, 64UL, 0U);
+    }
+    #endif
+    return base;
+#endif
+}
+
+int* allocKeys(size_t count)
+{
+    size_t bytes = count * sizeof(int);
+    bool policy = alloc_policy.pages != Pages_Default || alloc_policy.numa != Numa_Default;
+    if (!policy || bytes < huge_page_bytes)
+        return new int[count];
+
+    bytes = (bytes + huge_page_bytes - 1) & ~(huge_page_bytes - 1);
+    void* base = mapKeys(bytes);
+    if (!base)
+        return new int[count];
+    if (alloc_policy.numa == Numa_Touch)
+        touchInParallel((char*)base, bytes);
+    std::lock_guard<std::mutex> lock(key_mappings_mutex);
+    key_mappings.push_back({ base, bytes });
+    return (int*)base;
+}
+
+void freeKeys(int* keys)
+{
+    {
+        std::lock_guard<std::mutex> lock(key_mappings_mutex);
+        for (size_t m = 0; m < key_mappings.size(); m++)
+        {
+            if (key_mappings[m].base != keys)
+                continue;
+#ifdef _WIN32
+            VirtualFree(keys, 0, MEM_RELEASE);
+#else
+            munmap(keys, key_mappings[m].bytes);
+#endif
+            key_mappings.erase(key_mappings.begin() + m);
+            return;
+        }
+    }
+    delete[] keys;
+}
+
+struct FreeKeys
+{
+    void operator()(int* keys) const { freeKeys(keys); }
+};
+
+// Owning handle for buffers that should follow the allocation policy
+typedef std::unique_ptr<int[], FreeKeys> KeyBuffer;
+
+// Where the pages of an array ended up: sampled node of up to 1024 pages and how
+// much of it is backed by huge pages. Only known on Linux, nodes is empty otherwise.
+struct KeyPlacement
+{
+    std::vector<int> nodes;     // sampled pages per node
+    size_t huge_kb  = 0;
+    size_t total_kb = 0;
+
+    std::string describe() const
+    {
+        std::string text;
+        if (total_kb)
+            text += "huge " + std::to_string(huge_kb >> 10) + " of " + std::to_string(total_kb >> 10) + " MB";
+        int sampled = 0;
+        for (int count : nodes)
+            sampled += count;
+        for (size_t node = 0; node < nodes.size() && sampled; node++)
+            if (nodes[node])
+                text += (text.empty() ? "node " : ", node ") + std::to_string(node) + " " + std::to_string(100 * nodes[node] / sampled) + "%";
+        return text.empty() ? "placement n/a" : text;
+    }
+};
+
+KeyPlacement keyPlacement(const int* keys, size_t count)
+{
+    KeyPlacement placement;
+#ifdef __linux__
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    uintptr_t first = (uintptr_t)keys & ~(uintptr_t)(page - 1), last = (uintptr_t)(keys + count);
+    size_t pages = (last - first + page - 1) / page;
+    #ifdef SYS_move_pages
+    size_t samples = std::min<size_t>(pages, 1024);
+    std::vector<void*> addresses(samples);
+    std::vector<int> status(samples, -1);
+    for (size_t s = 0; s < samples; s++)
+        addresses[s] = (void*)(first + pages * s / samples * page);
+    // No target nodes just asks where each page is
+    if (samples && syscall(SYS_move_pages, 0, (unsigned long)samples, addresses.data(), nullptr, status.data(), 0) == 0)
+        for (int node : status)
+            if (node >= 0 && node < 64)
+            {
+                if ((int)placement.nodes.size() <= node)
+                    placement.nodes.resize(node + 1);
+                placement.nodes[node]++;
+            }
+    #endif
+    // smaps has the huge page share of every mapping the array spans
+    FILE* file = fopen("/proc/self/smaps", "r");
+    if (!file)
+        return placement;
+    char line[256];
+    bool inside = false;
+    while (fgets(line, sizeof(line), file))
+    {
+        unsigned long from, to;
+        size_t kb;
+        if (sscanf(line, "%lx-%lx ", &from, &to) == 2 && strchr(line, '-') < strchr(line, ' '))
+            inside = to > first && from < last;
+        else if (!inside)
+            continue;
+        else if (sscanf(line, "Rss: %zu kB", &kb) == 1)
+            placement.total_kb += kb;
+        else if (sscanf(line, "AnonHugePages: %zu kB", &kb) == 1 || sscanf(line, "Private_Hugetlb: %zu kB", &kb) == 1)
+            placement.huge_kb += kb;
+    }
+    fclose(file);
+#else
+    (void)keys;
+    (void)count;
+#endif
+    return placement;
+}
+
+// Hardware misses of this thread and the threads it starts while counting, summed
+// over up to two events. -1 where perf events are missing or not allowed
+// (perf_event_paranoid).
+enum MissKind
+{
+    Miss_Dtlb,          // data TLB, loads and stores
+    Miss_Cache,         // last level cache
+};
+
+class MissCounter
+{
+public:
+    explicit MissCounter(MissKind kind) : kind(kind) {}
+
+    void start()
+    {
+#ifdef __linux__
+        const uint64_t dtlb = PERF_COUNT_HW_CACHE_DTLB | ((uint64_t)PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const uint64_t configs[2][2] = { { dtlb | (PERF_COUNT_HW_CACHE_OP_READ << 8), dtlb | (PERF_COUNT_HW_CACHE_OP_WRITE << 8) },
+                                         { PERF_COUNT_HW_CACHE_MISSES, 0 } };
+        for (int c = 0; c < (kind == Miss_Dtlb ? 2 : 1); c++)
+        {
+            perf_event_attr attr = {};
+            attr.type = kind == Miss_Dtlb ? PERF_TYPE_HW_CACHE : PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[kind][c];
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds[c] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fds[c] >= 0)
+            {
+                ioctl(fds[c], PERF_EVENT_IOC_RESET, 0);
+                ioctl(fds[c], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    long long stop()
+    {
+        long long misses = -1;
+#ifdef __linux__
+        for (int& fd : fds)
+        {
+            if (fd < 0)
+                continue;
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            long long count = 0;
+            if (read(fd, &count, sizeof(count)) == (ssize_t)sizeof(count))
+                misses = std::max(misses, 0LL) + count;
+            close(fd);
+            fd = -1;
+        }
+#endif
+        return misses;
+    }
+
+    ~MissCounter() { stop(); }
+
+private:
+    MissKind kind;
+    int      fds[2] = { -1, -1 };
+};
+
 void updateIntArray(const int number, int*& array)
 {
-    array = new int[number];
+    array = allocKeys(number);
     for (int i = 0; i < number; i++) array[i] = i;
 }
 
 void copyPasteArray(const int number, int*& copy, int*& paste)
 {
-    paste = new int[number];
+    paste = allocKeys(number);
     for (int i = 0; i < number; i++) {
         paste[i] = copy[i];
     }
@@ -55,221 +936,5289 @@ void copyPasteArray(const int number, int*& copy, int*& paste)
 std::random_device dev;
 std::mt19937 rnd(dev());
 
-void shuffleIntArray(const int number, int*& array)
+void shuffleIntArray(const int number, int*& array, std::mt19937& gen)
 {
     for (int i = number - 1; i > 0; i--)
     {
-        std::uniform_int_distribution<int> dist(0, i);
-        int j = dist(rnd);
-        std::swap(array[i], array[j]);
+        std::uniform_int_distribution<int> dist(0, i);
+        int j = dist(gen);
+        std::swap(array[i], array[j]);
+        noteWrite(i, array[i]);
+        noteWrite(j, array[j]);
+    }
+}
+
+void shuffleIntArray(const int number, int*& array)
+{
+    shuffleIntArray(number, array, rnd);
+}
+
+// In order except for about one key in every 8 swapped with one at most window places
+// ahead, like log timestamps where a few entries arrive late
+void nearlySortIntArray(const int number, int*& array, std::mt19937& gen, int window = 16)
+{
+    for (int i = 0; i < number; i++)
+    {
+        array[i] = i;
+        noteWrite(i, array[i]);
+    }
+    std::uniform_int_distribution<int> late(0, 7);
+    for (int i = 0; i + 1 < number; i++)
+    {
+        if (late(gen) != 0)
+            continue;
+        std::uniform_int_distribution<int> dist(i + 1, std::min(number - 1, i + window));
+        int j = dist(gen);
+        std::swap(array[i], array[j]);
+        noteWrite(i, array[i]);
+        noteWrite(j, array[j]);
+    }
+}
+
+bool verifyArrayIsSorted(int*& array, const int number)
+{
+    return std::is_sorted(array, array + number);
+}
+
+// Order-independent hash of the keys, equal before and after a sort only if no
+// key was lost or duplicated (barring a collision)
+uint64_t keyFingerprint(const int* array, const int number)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < number; i++)
+    {
+        uint64_t x = (uint32_t)array[i] + 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        sum += x ^ (x >> 31);
+    }
+    return sum;
+}
+
+//---------------------------------------------------------------------------------
+//      SORTS
+//---------------------------------------------------------------------------------
+
+std::mutex numbers_mutex;
+
+// Benchmark workers sort private buffers nobody draws, so they skip the display locks
+thread_local bool bench_worker = false;
+
+typedef void (*SortFunction)(int*, const int, std::atomic<int>&, std::atomic<double>&);
+
+//------BOGO-----------------------------------------------------------------------
+std::mutex bogo_numbers_mutex;
+DirtyBlocks bogo_dirty;
+std::future<void> bogo_future;
+std::atomic<int> bogo_iterations(0);
+std::atomic<double> bogo_sort_time_ms(0.0);
+std::chrono::time_point<std::chrono::high_resolution_clock> bogo_start_time;
+
+void bogoSort(int* array, const int number, std::atomic<int>& iter_count, std::atomic<double>& sort_time_ms)
+{
+    iter_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    while (true) {
+        iter_count++;
+        {
+            std::lock_guard<std::mutex> lock(bogo_numbers_mutex);
+            if (verifyArrayIsSorted(array, number))
+                break;
+            shuffleIntArray(number, array);
+        }
+        std::this_thread::yield();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+//------SHELL----------------------------------------------------------------------
+std::mutex shell_numbers_mutex;
+DirtyBlocks shell_dirty;
+std::future<void> shell_future;
+std::atomic<int> shell_operations(0);
+std::atomic<double> shell_sort_time_ms(0.0);
+std::chrono::time_point<std::chrono::high_resolution_clock> shell_start_time;
+
+void shellSort(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    
+    // Start with a big gap, then reduce the gap
+    for (int gap = number/2; gap > 0; gap /= 2)
+    {
+        // Do a gapped insertion sort for this gap size.
+        // The first gap elements a[0..gap-1] are already in gapped order
+        // keep adding one more element until the entire array is
+        // gap sorted 
+        for (int i = gap; i < number; i += 1)
+        {
+            // add a[i] to the elements that have been gap sorted
+            // save a[i] in temp and make a hole at position i
+            int temp = array[i];
+
+            // shift earlier gap-sorted elements up until the correct 
+            // location for a[i] is found
+            int j;
+            
+            for (j = i; j >= gap && array[j - gap] > temp; j -= gap)
+            {
+                array[j] = array[j - gap];
+                noteWrite(j, array[j]);
+                oper_count++;
+            }
+
+            //  put temp (the original a[i]) in its correct location
+            array[j] = temp;
+            noteWrite(j, temp);
+            oper_count++;
+            
+            std::this_thread::yield();
+        }
+    }
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+//------KEY RANGE------------------------------------------------------------------
+//
+// Min/max scan shared by radix, counting and auto. It is one pass that does
+// nothing but read, so it should run at memory speed: the widest vector unit
+// the CPU has is picked at startup, and huge arrays are split over threads.
+
+enum SimdLevel
+{
+    SimdLevel_Scalar,
+    SimdLevel_SSE2,
+    SimdLevel_AVX2,
+    SimdLevel_AVX512,
+};
+
+const char* simd_level_names[] = { "scalar", "sse2", "avx2", "avx512" };
+
+SimdLevel detectSimdLevel()
+{
+#if defined(SORTIK_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    if (!(info[3] & (1 << 26)))
+        return SimdLevel_Scalar;
+    // AVX state has to be enabled by the OS too, not just present
+    unsigned long long xcr0 = (info[2] & (1 << 27)) ? _xgetbv(0) : 0;
+    if (max_leaf < 7 || (xcr0 & 0x6) != 0x6)
+        return SimdLevel_SSE2;
+    __cpuidex(info, 7, 0);
+    if ((info[1] & (1 << 16)) && (xcr0 & 0xe6) == 0xe6)
+        return SimdLevel_AVX512;
+    return (info[1] & (1 << 5)) ? SimdLevel_AVX2 : SimdLevel_SSE2;
+#elif defined(SORTIK_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel_AVX2;
+    return __builtin_cpu_supports("sse2") ? SimdLevel_SSE2 : SimdLevel_Scalar;
+#else
+    return SimdLevel_Scalar;
+#endif
+}
+
+// What the CPU can do, lowered by --simd to compare kernels
+const SimdLevel simd_supported = detectSimdLevel();
+SimdLevel simd_level = simd_supported;
+
+// Eight independent lanes, so even without intrinsics the compiler keeps them
+// in vector registers. Ternaries because std::min's reference return counts as
+// control flow to the vectorizer.
+void keyRangeScalar(const int* array, int number, int& min, int& max)
+{
+    int lo[8], hi[8];
+    for (int k = 0; k < 8; k++)
+        lo[k] = hi[k] = array[0];
+    int i = 0;
+    for (; i + 8 <= number; i += 8)
+        for (int k = 0; k < 8; k++)
+        {
+            int value = array[i + k];
+            lo[k] = value < lo[k] ? value : lo[k];
+            hi[k] = value > hi[k] ? value : hi[k];
+        }
+    for (; i < number; i++)
+    {
+        lo[0] = std::min(lo[0], array[i]);
+        hi[0] = std::max(hi[0], array[i]);
+    }
+    min = *std::min_element(lo, lo + 8);
+    max = *std::max_element(hi, hi + 8);
+}
+
+#ifdef SORTIK_X86
+// SSE2 has no 32-bit min/max, so it's compare and select
+static inline __m128i min32(__m128i a, __m128i b)
+{
+    __m128i less = _mm_cmplt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(less, a), _mm_andnot_si128(less, b));
+}
+
+static inline __m128i max32(__m128i a, __m128i b)
+{
+    __m128i less = _mm_cmplt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(less, b), _mm_andnot_si128(less, a));
+}
+
+void keyRangeSSE2(const int* array, int number, int& min, int& max)
+{
+    __m128i lo0 = _mm_set1_epi32(array[0]), lo1 = lo0, hi0 = lo0, hi1 = lo0;
+    int i = 0;
+    for (; i + 8 <= number; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)(array + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(array + i + 4));
+        lo0 = min32(lo0, a);
+        lo1 = min32(lo1, b);
+        hi0 = max32(hi0, a);
+        hi1 = max32(hi1, b);
+    }
+    int lo[4], hi[4];
+    _mm_storeu_si128((__m128i*)lo, min32(lo0, lo1));
+    _mm_storeu_si128((__m128i*)hi, max32(hi0, hi1));
+    min = std::min(std::min(lo[0], lo[1]), std::min(lo[2], lo[3]));
+    max = std::max(std::max(hi[0], hi[1]), std::max(hi[2], hi[3]));
+    for (; i < number; i++)
+    {
+        min = std::min(min, array[i]);
+        max = std::max(max, array[i]);
+    }
+}
+
+SORTIK_TARGET_AVX2
+void keyRangeAVX2(const int* array, int number, int& min, int& max)
+{
+    __m256i lo0 = _mm256_set1_epi32(array[0]), lo1 = lo0, hi0 = lo0, hi1 = lo0;
+    int i = 0;
+    for (; i + 16 <= number; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(array + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(array + i + 8));
+        lo0 = _mm256_min_epi32(lo0, a);
+        lo1 = _mm256_min_epi32(lo1, b);
+        hi0 = _mm256_max_epi32(hi0, a);
+        hi1 = _mm256_max_epi32(hi1, b);
+    }
+    int lo[8], hi[8];
+    _mm256_storeu_si256((__m256i*)lo, _mm256_min_epi32(lo0, lo1));
+    _mm256_storeu_si256((__m256i*)hi, _mm256_max_epi32(hi0, hi1));
+    min = *std::min_element(lo, lo + 8);
+    max = *std::max_element(hi, hi + 8);
+    for (; i < number; i++)
+    {
+        min = std::min(min, array[i]);
+        max = std::max(max, array[i]);
+    }
+}
+
+// GCC's own _mm512_undefined_epi32 inside min/max trips its uninitialized warnings
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+SORTIK_TARGET_AVX512
+void keyRangeAVX512(const int* array, int number, int& min, int& max)
+{
+    __m512i lo0 = _mm512_set1_epi32(array[0]), lo1 = lo0, hi0 = lo0, hi1 = lo0;
+    int i = 0;
+    for (; i + 32 <= number; i += 32)
+    {
+        __m512i a = _mm512_loadu_si512((const void*)(array + i));
+        __m512i b = _mm512_loadu_si512((const void*)(array + i + 16));
+        lo0 = _mm512_min_epi32(lo0, a);
+        lo1 = _mm512_min_epi32(lo1, b);
+        hi0 = _mm512_max_epi32(hi0, a);
+        hi1 = _mm512_max_epi32(hi1, b);
+    }
+    int lo[16], hi[16];
+    _mm512_storeu_si512((void*)lo, _mm512_min_epi32(lo0, lo1));
+    _mm512_storeu_si512((void*)hi, _mm512_max_epi32(hi0, hi1));
+    min = *std::min_element(lo, lo + 16);
+    max = *std::max_element(hi, hi + 16);
+    for (; i < number; i++)
+    {
+        min = std::min(min, array[i]);
+        max = std::max(max, array[i]);
+    }
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+typedef void (*KeyRangeKernel)(const int*, int, int&, int&);
+
+KeyRangeKernel keyRangeKernel()
+{
+    switch (simd_level)
+    {
+#ifdef SORTIK_X86
+    case SimdLevel_AVX512: return keyRangeAVX512;
+    case SimdLevel_AVX2:   return keyRangeAVX2;
+    case SimdLevel_SSE2:   return keyRangeSSE2;
+#endif
+    default:               return keyRangeScalar;
+    }
+}
+
+// Below this a thread costs more than the part of the scan it would take
+const int key_range_parallel_threshold = 1 << 22;
+
+void keyRange(const int* array, int number, int& min, int& max)
+{
+    if (number <= 0)
+    {
+        min = max = 0;
+        return;
+    }
+    KeyRangeKernel kernel = keyRangeKernel();
+    int workers = number >= key_range_parallel_threshold ? (int)std::min(16u, std::max(1u, std::thread::hardware_concurrency())) : 1;
+    if (workers == 1)
+    {
+        kernel(array, number, min, max);
+        return;
+    }
+
+    std::vector<int> mins(workers), maxs(workers);
+    auto scan = [&](int worker)
+    {
+        long long begin = (long long)number * worker / workers, end = (long long)number * (worker + 1) / workers;
+        kernel(array + begin, (int)(end - begin), mins[worker], maxs[worker]);
+    };
+    std::vector<std::thread> threads;
+    for (int w = 1; w < workers; w++)
+        threads.emplace_back(scan, w);
+    scan(0);
+    for (std::thread& thread : threads)
+        thread.join();
+    min = *std::min_element(mins.begin(), mins.end());
+    max = *std::max_element(maxs.begin(), maxs.end());
+}
+
+// Runs task(0) .. task(tasks - 1) on up to workers threads, each taking the next index
+// off a shared counter. The caller's dirty set follows the work onto the other threads.
+template <typename Task>
+void runTasks(int tasks, int workers, Task task)
+{
+    std::atomic<int> next(0);
+    DirtyBlocks* dirty = dirty_blocks;
+    auto drain = [&]()
+    {
+        dirty_blocks = dirty;
+        for (int t = next++; t < tasks; t = next++)
+            task(t);
+    };
+    std::vector<std::thread> threads;
+    for (int w = 1; w < std::min(workers, tasks); w++)
+        threads.emplace_back(drain);
+    drain();
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+// Buffers given back are kept for the next borrower they are big enough for
+class ScratchPool
+{
+public:
+    class Lease
+    {
+    public:
+        Lease(ScratchPool* pool, KeyBuffer data, size_t bytes) : pool(pool), data(std::move(data)), bytes(bytes) {}
+        Lease(Lease&& other) : pool(other.pool), data(std::move(other.data)), bytes(other.bytes) { other.pool = nullptr; }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease()
+        {
+            if (pool && data)
+                pool->giveBack(std::move(data), bytes);
+        }
+
+        template <typename T>
+        T* as() { return reinterpret_cast<T*>(data.get()); }
+
+    private:
+        ScratchPool*            pool;
+        KeyBuffer data;
+        size_t                  bytes;
+    };
+
+    Lease borrow(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // The smallest buffer that fits, so a big one stays free for a big sort
+        int best = -1;
+        for (int i = 0; i < (int)free_buffers.size(); i++)
+            if (free_buffers[i].bytes >= bytes && (best < 0 || free_buffers[i].bytes < free_buffers[best].bytes))
+                best = i;
+        if (best < 0)
+            return Lease(this, KeyBuffer(allocKeys(std::max<size_t>((bytes + sizeof(int) - 1) / sizeof(int), 1))), bytes);
+        Buffer buffer = std::move(free_buffers[best]);
+        free_buffers.erase(free_buffers.begin() + best);
+        return Lease(this, std::move(buffer.data), buffer.bytes);
+    }
+
+    size_t keptBytes()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t total = 0;
+        for (const Buffer& buffer : free_buffers)
+            total += buffer.bytes;
+        return total;
+    }
+
+private:
+    struct Buffer
+    {
+        KeyBuffer data;
+        size_t                  bytes;
+    };
+
+    static const int max_kept = 4;
+
+    void giveBack(KeyBuffer data, size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        free_buffers.push_back({ std::move(data), bytes });
+        if ((int)free_buffers.size() > max_kept)
+        {
+            auto smallest = std::min_element(free_buffers.begin(), free_buffers.end(),
+                                             [](const Buffer& a, const Buffer& b) { return a.bytes < b.bytes; });
+            free_buffers.erase(smallest);
+        }
+    }
+
+    std::mutex          mutex;
+    std::vector<Buffer> free_buffers;
+};
+
+ScratchPool scratch_pool;
+
+//------RADIX----------------------------------------------------------------------
+std::mutex radix_numbers_mutex;
+DirtyBlocks radix_dirty;
+std::future<void> radix_future;
+std::atomic<int> radix_operations(0);
+std::atomic<double> radix_sort_time_ms(0.0);
+std::chrono::time_point<std::chrono::high_resolution_clock> radix_start_time;
+
+// A stable pass of src into dst by the decimal digit at exp of each key's distance
+// from lowest, which is never negative and fits 32 bits unsigned. Only writes that
+// land in the visible array are noted, the other half of the passes go to scratch.
+void countSort(const int* src, int* dst, int n, int lowest, uint64_t exp, bool visible, std::atomic<int>& oper_count)
+{
+    int count[10] = { 0 };
+    auto digit = [&](int x) { return (int)(((uint32_t)x - (uint32_t)lowest) / exp % 10); };
+
+    // Store count of occurrences
+    for (int i = 0; i < n; i++)
+        count[digit(src[i])]++;
+
+    // Change count[i] to contain actual position
+    for (int i = 1; i < 10; i++)
+        count[i] += count[i - 1];
+
+    // Build the output array
+    for (int i = n - 1; i >= 0; i--)
+    {
+        int position = --count[digit(src[i])];
+        dst[position] = src[i];
+        if (visible)
+            noteWrite(position, src[i]);
+    }
+
+    // One add per pass, an atomic add per key cost as much as the pass itself
+    oper_count += 2 * n + 9;
+}
+
+void radixSort(int* arr, int n, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // Digits are taken from key - lowest, so the span sets the number of passes
+    // and negative keys sort too
+    int lowest, m;
+    keyRange(arr, n, lowest, m);
+    uint64_t span = (uint32_t)m - (uint32_t)lowest;
+    oper_count += n;
+
+    // Passes go back and forth between the array and a pooled buffer that outlives the run
+    ScratchPool::Lease scratch = scratch_pool.borrow((size_t)n * sizeof(int));
+    int* source = arr;
+    int* target = scratch.as<int>();
+
+    // Do counting sort for every digit
+    for (uint64_t exp = 1; span / exp > 0; exp *= 10) {
+        {
+            std::unique_lock<std::mutex> lock(radix_numbers_mutex, std::defer_lock);
+            if (!bench_worker)
+                lock.lock();
+            countSort(source, target, n, lowest, exp, target == arr, oper_count);
+        }
+        std::swap(source, target);
+
+        std::this_thread::yield();
+    }
+
+    // An odd number of passes left the keys in scratch
+    if (source != arr)
+    {
+        std::unique_lock<std::mutex> lock(radix_numbers_mutex, std::defer_lock);
+        if (!bench_worker)
+            lock.lock();
+        memcpy(arr, source, (size_t)n * sizeof(int));
+        if (trace_recorder || dirty_blocks)
+            for (int i = 0; i < n; i++)
+                noteWrite(i, arr[i]);
+        oper_count += n;
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+//------LSD RADIX------------------------------------------------------------------
+//
+// Byte-wise LSD radix on keys biased by the smallest one, so negative keys sort
+// too. All histograms come from one read of the array and passes whose digit is
+// the same for every key are skipped. Every other pass scatters a key to one of
+// 256 places, which misses in cache and in the TLB on every write once the array
+// is past L3. Combining scatter stages keys in a cache line per bucket instead
+// and writes whole lines at once with non-temporal stores, so each line is
+// written once without being read first.
+
+enum ScatterMode
+{
+    Scatter_Direct,
+    Scatter_Combining,
+};
+
+const int lsd_line_keys = 64 / sizeof(int);
+
+struct alignas(64) ScatterLine
+{
+    int keys[lsd_line_keys];
+};
+
+// Slot of a destination in its cache line, so full lines land on line boundaries
+inline int lineSlot(const int* at)
+{
+    return (int)(((uintptr_t)at / sizeof(int)) & (lsd_line_keys - 1));
+}
+
+inline void streamLine(int* to, const ScatterLine& line)
+{
+#ifdef SORTIK_X86
+    for (int q = 0; q < lsd_line_keys; q += 4)
+        _mm_stream_si128((__m128i*)(to + q), _mm_load_si128((const __m128i*)(line.keys + q)));
+#else
+    memcpy(to, line.keys, sizeof(line.keys));
+#endif
+}
+
+template <ScatterMode mode>
+void lsdScatter(const int* source, int* target, int64_t number, int shift, unsigned bias, const int64_t* offsets, bool visible)
+{
+    int64_t next[256];
+    memcpy(next, offsets, sizeof(next));
+    if (mode == Scatter_Direct)
+    {
+        for (int64_t i = 0; i < number; i++)
+        {
+            int64_t at = next[(((unsigned)source[i] - bias) >> shift) & 0xFF]++;
+            target[at] = source[i];
+        }
+    }
+    else
+    {
+        std::unique_ptr<ScatterLine[]> lines(new ScatterLine[256]);
+        int64_t staged[256];    // target index of the first key waiting in each line
+        memcpy(staged, offsets, sizeof(staged));
+        for (int64_t i = 0; i < number; i++)
+        {
+            int digit = (((unsigned)source[i] - bias) >> shift) & 0xFF;
+            int64_t at = next[digit]++;
+            int slot = lineSlot(target + at);
+            lines[digit].keys[slot] = source[i];
+            if (slot != lsd_line_keys - 1)
+                continue;
+            int64_t first = at + 1 - lsd_line_keys;
+            if (staged[digit] == first)
+                streamLine(target + first, lines[digit]);
+            else // the bucket started part way into this line
+                memcpy(target + staged[digit], lines[digit].keys + lineSlot(target + staged[digit]), (size_t)(at + 1 - staged[digit]) * sizeof(int));
+            staged[digit] = at + 1;
+        }
+        for (int digit = 0; digit < 256; digit++)
+            if (staged[digit] < next[digit])
+                memcpy(target + staged[digit], lines[digit].keys + lineSlot(target + staged[digit]), (size_t)(next[digit] - staged[digit]) * sizeof(int));
+#ifdef SORTIK_X86
+        // Streamed lines have to be visible before anyone reads the target
+        _mm_sfence();
+#endif
+    }
+    if (visible && (trace_recorder || dirty_blocks))
+        for (int64_t i = 0; i < number; i++)
+            noteWrite((int)i, target[i]);
+}
+
+template <ScatterMode mode>
+void lsdRadixSortEngine(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    int min, max;
+    keyRange(array, number, min, max);
+    unsigned bias = (unsigned)min;
+
+    int64_t counts[4][256] = {};
+    for (int i = 0; i < number; i++)
+    {
+        unsigned key = (unsigned)array[i] - bias;
+        counts[0][key & 0xFF]++;
+        counts[1][(key >> 8) & 0xFF]++;
+        counts[2][(key >> 16) & 0xFF]++;
+        counts[3][key >> 24]++;
+    }
+    oper_count += 2 * number;
+
+    ScratchPool::Lease scratch = scratch_pool.borrow((size_t)number * sizeof(int));
+    int* source = array;
+    int* target = scratch.as<int>();
+    for (int pass = 0; pass < 4; pass++)
+    {
+        int64_t offsets[256];
+        int64_t total = 0;
+        for (int digit = 0; digit < 256; digit++)
+        {
+            offsets[digit] = total;
+            total += counts[pass][digit];
+        }
+        if (std::find(counts[pass], counts[pass] + 256, (int64_t)number) != counts[pass] + 256)
+            continue;   // one bucket holds every key
+
+        lsdScatter<mode>(source, target, number, pass * 8, bias, offsets, target == array);
+        std::swap(source, target);
+        oper_count += number;
+    }
+
+    if (source != array)
+    {
+        memcpy(array, source, (size_t)number * sizeof(int));
+        if (trace_recorder || dirty_blocks)
+            for (int i = 0; i < number; i++)
+                noteWrite(i, array[i]);
+        oper_count += number;
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+//------COUNTING-------------------------------------------------------------------
+//
+// Sortik's arrays are permutations of 0..n-1, which radix still takes apart
+// digit by digit. When the keys span only a few times n, one histogram pass
+// and one pass writing the keys back in order do the whole job. Wider keys go
+// to the byte-wise LSD engine.
+
+// Counting sort gives up beyond keys spanning this many times the array size
+const int counting_max_range = 4;
+
+// Sorts keys known to lie in [min, max], whatever the range
+void countingSortRange(int* array, int number, int min, int max, std::atomic<int>& oper_count)
+{
+    std::vector<int> counts((size_t)((long long)max - min + 1), 0);
+    for (int i = 0; i < number; i++)
+        counts[(unsigned)array[i] - (unsigned)min]++;
+    oper_count += number;
+
+    // Progress goes out in chunks, an atomic add per key would cost more than the write
+    const int chunk = 4096;
+    int i = 0, reported = 0;
+    for (size_t key = 0; key < counts.size(); key++)
+    {
+        int value = (int)((long long)min + (long long)key);
+        for (int c = counts[key]; c > 0; c--, i++)
+        {
+            array[i] = value;
+            noteWrite(i, value);
+        }
+        if (i - reported >= chunk)
+        {
+            oper_count += i - reported;
+            reported = i;
+        }
+    }
+    oper_count += i - reported;
+}
+
+void countingSort(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    int min, max;
+    keyRange(array, number, min, max);
+    long long range = (long long)max - min + 1;
+    if (range <= (long long)counting_max_range * number)
+        countingSortRange(array, number, min, max, oper_count);
+    else
+        lsdRadixSortEngine<Scatter_Combining>(array, number, oper_count, sort_time_ms);  // any range, at most four passes
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+//------SORTING NETWORKS-----------------------------------------------------------
+//
+// Branch-free sorts for up to 64 ints, the base case of the comparison engines.
+// A block sits in 1, 2, 4 or 8 AVX2 registers padded with INT_MAX. Each register
+// is sorted on its own by Batcher's 19-comparator network (six layers of
+// permute, min, max and blend), then sorted registers are merged pairwise with
+// bitonic merges until one run is left.
+
+#ifdef SORTIK_X86
+// One layer of the network: every lane meets the lane `partner` names, lanes
+// set in `upper` keep the larger value
+#define SORTIK_NETWORK_LAYER(v, p0, p1, p2, p3, p4, p5, p6, p7, upper)                      \
+    {                                                                                       \
+        __m256i partner = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(p0, p1, p2, p3, p4, p5, p6, p7)); \
+        v = _mm256_blend_epi32(_mm256_min_epi32(v, partner), _mm256_max_epi32(v, partner), upper); \
+    }
+
+SORTIK_TARGET_AVX2
+static inline __m256i sortRegister(__m256i v)
+{
+    SORTIK_NETWORK_LAYER(v, 1, 0, 3, 2, 5, 4, 7, 6, 0xAA);
+    SORTIK_NETWORK_LAYER(v, 2, 3, 0, 1, 6, 7, 4, 5, 0xCC);
+    SORTIK_NETWORK_LAYER(v, 0, 2, 1, 3, 4, 6, 5, 7, 0x44);
+    SORTIK_NETWORK_LAYER(v, 4, 5, 6, 7, 0, 1, 2, 3, 0xF0);
+    SORTIK_NETWORK_LAYER(v, 0, 1, 4, 5, 2, 3, 6, 7, 0x30);
+    SORTIK_NETWORK_LAYER(v, 0, 2, 1, 4, 3, 6, 5, 7, 0x54);
+    return v;
+}
+
+// Sorts a register that holds a bitonic sequence
+SORTIK_TARGET_AVX2
+static inline __m256i cleanRegister(__m256i v)
+{
+    SORTIK_NETWORK_LAYER(v, 4, 5, 6, 7, 0, 1, 2, 3, 0xF0);
+    SORTIK_NETWORK_LAYER(v, 2, 3, 0, 1, 6, 7, 4, 5, 0xCC);
+    SORTIK_NETWORK_LAYER(v, 1, 0, 3, 2, 5, 4, 7, 6, 0xAA);
+    return v;
+}
+
+#undef SORTIK_NETWORK_LAYER
+
+SORTIK_TARGET_AVX2
+static inline __m256i reverseRegister(__m256i v)
+{
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+// v[0, k) and v[k, 2k) are each sorted across registers, afterwards all of v is
+SORTIK_TARGET_AVX2
+static inline void mergeRegisters(__m256i* v, int k)
+{
+    // Reversing the second run makes the whole thing bitonic
+    for (int i = 0; i < k; i++)
+    {
+        __m256i a = v[i], b = reverseRegister(v[2 * k - 1 - i]);
+        v[i] = _mm256_min_epi32(a, b);
+        v[2 * k - 1 - i] = reverseRegister(_mm256_max_epi32(a, b));
+    }
+    // max(a, b) was stored reversed back, so both halves are bitonic again
+    for (int half = 0; half < 2; half++)
+    {
+        __m256i* run = v + half * k;
+        for (int distance = k / 2; distance > 0; distance /= 2)
+            for (int i = 0; i < k; i++)
+                if (!(i & distance))
+                {
+                    __m256i a = run[i], b = run[i + distance];
+                    run[i] = _mm256_min_epi32(a, b);
+                    run[i + distance] = _mm256_max_epi32(a, b);
+                }
+        for (int i = 0; i < k; i++)
+            run[i] = cleanRegister(run[i]);
+    }
+}
+
+SORTIK_TARGET_AVX2
+void sortSmallAVX2(int* data, int count)
+{
+    int registers = count <= 8 ? 1 : count <= 16 ? 2 : count <= 32 ? 4 : 8;
+    __m256i v[8];
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    for (int r = 0; r < registers; r++)
+    {
+        // Lanes past the end load as INT_MAX and sort to the back
+        __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(count - r * 8), lanes);
+        __m256i loaded = _mm256_maskload_epi32(data + r * 8, mask);
+        v[r] = sortRegister(_mm256_blendv_epi8(_mm256_set1_epi32(INT_MAX), loaded, mask));
+    }
+    for (int k = 1; k < registers; k *= 2)
+        for (int r = 0; r < registers; r += 2 * k)
+            mergeRegisters(v + r, k);
+    for (int r = 0; r < registers; r++)
+    {
+        __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(count - r * 8), lanes);
+        _mm256_maskstore_epi32(data + r * 8, mask, v[r]);
+    }
+}
+#endif
+
+const int network_max = 64;
+
+// Sorts up to network_max ints in place, with the network where AVX2 is there
+void sortSmall(int* data, int count)
+{
+#ifdef SORTIK_X86
+    if (simd_level >= SimdLevel_AVX2)
+    {
+        if (count > 1)
+            sortSmallAVX2(data, count);
+        return;
+    }
+#endif
+    for (int i = 1; i < count; i++)
+    {
+        int temp = data[i], j = i;
+        for (; j > 0 && data[j - 1] > temp; j--)
+            data[j] = data[j - 1];
+        data[j] = temp;
+    }
+}
+
+#ifdef SORTIK_X86
+// Merges sorted a[0, na) and b[0, nb) into out, eight at a time: the smaller
+// half of a 16-way bitonic merge goes out, the larger half waits for the next
+// eight from whichever run has the smaller head
+SORTIK_TARGET_AVX2
+void mergeAVX2(const int* a, int na, const int* b, int nb, int* out)
+{
+    int ia = 0, ib = 0;
+    if (na >= 8 && nb >= 8)
+    {
+        __m256i v[2] = { _mm256_loadu_si256((const __m256i*)a), _mm256_loadu_si256((const __m256i*)b) };
+        ia = ib = 8;
+        mergeRegisters(v, 1);
+        _mm256_storeu_si256((__m256i*)out, v[0]);
+        out += 8;
+        while (ia + 8 <= na && ib + 8 <= nb)
+        {
+            if (a[ia] < b[ib])
+                v[0] = _mm256_loadu_si256((const __m256i*)(a + ia)), ia += 8;
+            else
+                v[0] = _mm256_loadu_si256((const __m256i*)(b + ib)), ib += 8;
+            mergeRegisters(v, 1);
+            _mm256_storeu_si256((__m256i*)out, v[0]);
+            out += 8;
+        }
+        // What's left: the eight held back, under eight of one run and the rest of the other
+        int held[8], tail[16];
+        _mm256_storeu_si256((__m256i*)held, v[1]);
+        const int* short_run = ia + 8 > na ? a + ia : b + ib;
+        int short_count = ia + 8 > na ? na - ia : nb - ib;
+        int tail_count = (int)(std::merge(held, held + 8, short_run, short_run + short_count, tail) - tail);
+        if (ia + 8 > na)
+            std::merge(tail, tail + tail_count, b + ib, b + nb, out);
+        else
+            std::merge(a + ia, a + na, tail, tail + tail_count, out);
+        return;
+    }
+    std::merge(a, a + na, b, b + nb, out);
+}
+#endif
+
+// Stable only for plain ints, where equal keys can't be told apart anyway
+void mergeRuns(const int* a, int na, const int* b, int nb, int* out)
+{
+#ifdef SORTIK_X86
+    if (simd_level >= SimdLevel_AVX2)
+    {
+        mergeAVX2(a, na, b, nb, out);
+        return;
+    }
+#endif
+    std::merge(a, a + na, b, b + nb, out);
+}
+
+//------BLOCK MERGE----------------------------------------------------------------
+
+// Networks sort every 64 ints, then merge passes double the runs until one is
+// left. Passes ping-pong between the array and a buffer, so the chart only
+// moves on the passes that land in the array.
+void blockMergeSort(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    for (int begin = 0; begin < number; begin += network_max)
+    {
+        int count = std::min(network_max, number - begin);
+        sortSmall(array + begin, count);
+        for (int i = begin; i < begin + count; i++)
+            noteWrite(i, array[i]);
+        oper_count += count;
+    }
+
+    // Merges go back and forth between the array and a pooled buffer
+    ScratchPool::Lease scratch = scratch_pool.borrow((size_t)number * sizeof(int));
+    int* from = array;
+    int* to = scratch.as<int>();
+    // 64-bit, doubling past 2^30 would overflow an int
+    for (int64_t width = network_max; width < number; width *= 2)
+    {
+        for (int64_t begin = 0; begin < number; begin += 2 * width)
+        {
+            int64_t middle = std::min<int64_t>(begin + width, number), end = std::min<int64_t>(begin + 2 * width, number);
+            mergeRuns(from + begin, (int)(middle - begin), from + middle, (int)(end - middle), to + begin);
+        }
+        if (to == array)
+            for (int i = 0; i < number; i++)
+                noteWrite(i, array[i]);
+        oper_count += number;
+        std::swap(from, to);
+        std::this_thread::yield();
+    }
+    if (from != array)
+    {
+        for (int i = 0; i < number; i++)
+        {
+            array[i] = from[i];
+            noteWrite(i, array[i]);
+        }
+        oper_count += number;
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+//------VECTOR QUICKSORT-----------------------------------------------------------
+//
+// Quicksort whose partition works on whole vectors, in the spirit of vqsort and
+// x86-simd-sort. Each vector is compared with the pivot and its lanes reordered
+// so the ones going left come first, then it's stored at the left end of the
+// hole and again at the right end. One vector preloaded from each end of the
+// range keeps a vector's worth of room on both sides, so it all stays in place.
+// Keys can be int32, uint32, int64 or float (no NaNs, same as std::sort).
+// Without AVX2 it is std::sort.
+
+template <typename T>
+inline bool goesLeft(T x, T pivot, bool or_equal)
+{
+    return or_equal ? !(pivot < x) : x < pivot;
+}
+
+template <typename T>
+int64_t partitionScalar(T* arr, int64_t left, int64_t right, T pivot, bool or_equal)
+{
+    for (int64_t j = left; j < right; j++)
+        if (goesLeft(arr[j], pivot, or_equal))
+            std::swap(arr[left++], arr[j]);
+    return left;
+}
+
+inline int bitCount(unsigned x)
+{
+    x = x - ((x >> 1) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    return (int)((((x + (x >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+}
+
+#ifdef SORTIK_X86
+// AVX2 has no compress, so the lane order for every mask comes from a table:
+// lanes set in the mask first, the others after them
+struct CompressTables
+{
+    int32_t lanes8[256][8];
+    int32_t lanes4[16][8];   // 64-bit lanes as pairs of 32-bit ones
+
+    CompressTables()
+    {
+        for (int mask = 0; mask < 256; mask++)
+        {
+            int out = 0;
+            for (int pass = 0; pass < 2; pass++)
+                for (int lane = 0; lane < 8; lane++)
+                    if (((mask >> lane) & 1) == (pass == 0))
+                        lanes8[mask][out++] = lane;
+        }
+        for (int mask = 0; mask < 16; mask++)
+        {
+            int out = 0;
+            for (int pass = 0; pass < 2; pass++)
+                for (int lane = 0; lane < 4; lane++)
+                    if (((mask >> lane) & 1) == (pass == 0))
+                    {
+                        lanes4[mask][out++] = 2 * lane;
+                        lanes4[mask][out++] = 2 * lane + 1;
+                    }
+        }
+    }
+};
+
+const CompressTables compress_tables;
+
+// What the partition loop needs from a vector unit and a key type:
+//  - load / set1
+//  - leftMask:   bit per lane that goes left of the pivot
+//  - storeSplit: left lanes at `left`, the rest ending at right + width,
+//                returns how many went left
+
+struct QuickAVX2x32
+{
+    typedef __m256i reg;
+    static const int width = 8;
+
+    SORTIK_TARGET_AVX2 static inline reg load(const void* p) { return _mm256_loadu_si256((const __m256i*)p); }
+
+    SORTIK_TARGET_AVX2 static inline int storeSplit(void* left, void* right, reg v, unsigned mask)
+    {
+        v = _mm256_permutevar8x32_epi32(v, _mm256_loadu_si256((const __m256i*)compress_tables.lanes8[mask]));
+        _mm256_storeu_si256((__m256i*)left, v);
+        _mm256_storeu_si256((__m256i*)right, v);
+        return bitCount(mask);
+    }
+};
+
+struct QuickAVX2Int32 : QuickAVX2x32
+{
+    typedef int32_t T;
+    SORTIK_TARGET_AVX2 static inline reg set1(T x) { return _mm256_set1_epi32(x); }
+    SORTIK_TARGET_AVX2 static inline unsigned leftMask(reg v, reg pivot, bool or_equal)
+    {
+        if (or_equal)
+            return ~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, pivot))) & 0xFF;
+        return (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pivot, v)));
+    }
+};
+
+// Unsigned order is signed order with the top bit flipped
+struct QuickAVX2UInt32 : QuickAVX2x32
+{
+    typedef uint32_t T;
+    SORTIK_TARGET_AVX2 static inline reg set1(T x) { return _mm256_set1_epi32((int)(x ^ 0x80000000u)); }
+    SORTIK_TARGET_AVX2 static inline unsigned leftMask(reg v, reg pivot, bool or_equal)
+    {
+        return QuickAVX2Int32::leftMask(_mm256_xor_si256(v, _mm256_set1_epi32(INT_MIN)), pivot, or_equal);
+    }
+};
+
+struct QuickAVX2Float : QuickAVX2x32
+{
+    typedef float T;
+    SORTIK_TARGET_AVX2 static inline reg set1(T x) { return _mm256_castps_si256(_mm256_set1_ps(x)); }
+    SORTIK_TARGET_AVX2 static inline unsigned leftMask(reg v, reg pivot, bool or_equal)
+    {
+        __m256 a = _mm256_castsi256_ps(v), b = _mm256_castsi256_ps(pivot);
+        return (unsigned)_mm256_movemask_ps(or_equal ? _mm256_cmp_ps(a, b, _CMP_LE_OQ) : _mm256_cmp_ps(a, b, _CMP_LT_OQ));
+    }
+};
+
+struct QuickAVX2Int64
+{
+    typedef int64_t T;
+    typedef __m256i reg;
+    static const int width = 4;
+
+    SORTIK_TARGET_AVX2 static inline reg load(const void* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    SORTIK_TARGET_AVX2 static inline reg set1(T x) { return _mm256_set1_epi64x(x); }
+
+    SORTIK_TARGET_AVX2 static inline unsigned leftMask(reg v, reg pivot, bool or_equal)
+    {
+        if (or_equal)
+            return ~(unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(v, pivot))) & 0xF;
+        return (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(pivot, v)));
+    }
+
+    SORTIK_TARGET_AVX2 static inline int storeSplit(void* left, void* right, reg v, unsigned mask)
+    {
+        v = _mm256_permutevar8x32_epi32(v, _mm256_loadu_si256((const __m256i*)compress_tables.lanes4[mask]));
+        _mm256_storeu_si256((__m256i*)left, v);
+        _mm256_storeu_si256((__m256i*)right, v);
+        return bitCount(mask);
+    }
+};
+
+// AVX-512 compresses in a register. The left side may take a whole vector of
+// spill, the right side is a masked store so it ends exactly where it should.
+struct QuickAVX512x32
+{
+    typedef __m512i reg;
+    static const int width = 16;
+
+    SORTIK_TARGET_AVX512 static inline reg load(const void* p) { return _mm512_loadu_si512(p); }
+
+    SORTIK_TARGET_AVX512 static inline int storeSplit(void* left, void* right, reg v, unsigned mask)
+    {
+        int count = bitCount(mask);
+        _mm512_storeu_si512(left, _mm512_maskz_compress_epi32((__mmask16)mask, v));
+        _mm512_mask_storeu_epi32((int32_t*)right + count, (__mmask16)((1u << (width - count)) - 1),
+                                 _mm512_maskz_compress_epi32((__mmask16)~mask, v));
+        return count;
+    }
+};
+
+struct QuickAVX512Int32 : QuickAVX512x32
+{
+    typedef int32_t T;
+    SORTIK_TARGET_AVX512 static inline reg set1(T x) { return _mm512_set1_epi32(x); }
+    SORTIK_TARGET_AVX512 static inline unsigned leftMask(reg v, reg pivot, bool or_equal)
+    {
+        return or_equal ? _mm512_cmple_epi32_mask(v, pivot) : _mm512_cmplt_epi32_mask(v, pivot);
+    }
+};
+
+struct QuickAVX512UInt32 : QuickAVX512x32
+{
+    typedef uint32_t T;
+    SORTIK_TARGET_AVX512 static inline reg set1(T x) { return _mm512_set1_epi32((int)x); }
+    SORTIK_TARGET_AVX512 static inline unsigned leftMask(reg v, reg pivot, bool or_equal)
+    {
+        return or_equal ? _mm512_cmple_epu32_mask(v, pivot) : _mm512_cmplt_epu32_mask(v, pivot);
+    }
+};
+
+struct QuickAVX512Float : QuickAVX512x32
+{
+    typedef float T;
+    SORTIK_TARGET_AVX512 static inline reg set1(T x) { return _mm512_castps_si512(_mm512_set1_ps(x)); }
+    SORTIK_TARGET_AVX512 static inline unsigned leftMask(reg v, reg pivot, bool or_equal)
+    {
+        __m512 a = _mm512_castsi512_ps(v), b = _mm512_castsi512_ps(pivot);
+        return or_equal ? _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ) : _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ);
+    }
+};
+
+struct QuickAVX512Int64
+{
+    typedef int64_t T;
+    typedef __m512i reg;
+    static const int width = 8;
+
+    SORTIK_TARGET_AVX512 static inline reg load(const void* p) { return _mm512_loadu_si512(p); }
+    SORTIK_TARGET_AVX512 static inline reg set1(T x) { return _mm512_set1_epi64(x); }
+
+    SORTIK_TARGET_AVX512 static inline unsigned leftMask(reg v, reg pivot, bool or_equal)
+    {
+        return or_equal ? _mm512_cmple_epi64_mask(v, pivot) : _mm512_cmplt_epi64_mask(v, pivot);
+    }
+
+    SORTIK_TARGET_AVX512 static inline int storeSplit(void* left, void* right, reg v, unsigned mask)
+    {
+        int count = bitCount(mask);
+        _mm512_storeu_si512(left, _mm512_maskz_compress_epi64((__mmask8)mask, v));
+        _mm512_mask_storeu_epi64((int64_t*)right + count, (__mmask8)((1u << (width - count)) - 1),
+                                 _mm512_maskz_compress_epi64((__mmask8)~mask, v));
+        return count;
+    }
+};
+
+template <typename T> struct QuickOps;
+template <> struct QuickOps<int32_t>  { typedef QuickAVX2Int32  AVX2; typedef QuickAVX512Int32  AVX512; };
+template <> struct QuickOps<uint32_t> { typedef QuickAVX2UInt32 AVX2; typedef QuickAVX512UInt32 AVX512; };
+template <> struct QuickOps<float>    { typedef QuickAVX2Float  AVX2; typedef QuickAVX512Float  AVX512; };
+template <> struct QuickOps<int64_t>  { typedef QuickAVX2Int64  AVX2; typedef QuickAVX512Int64  AVX512; };
+
+// Partitions [left, right) so keys that go left of the pivot come first and
+// returns where the others start. Written once and stamped out per vector unit:
+// GCC and Clang only inline the intrinsics into a function of the same target.
+#define SORTIK_VECTOR_PARTITION(TARGET, NAME)                                                   \
+template <typename Ops>                                                                         \
+TARGET int64_t NAME(typename Ops::T* arr, int64_t left, int64_t right, typename Ops::T pivot, bool or_equal) \
+{                                                                                               \
+    const int width = Ops::width;                                                               \
+    /* Trim to whole vectors, what's trimmed lands where it belongs */                          \
+    for (int64_t i = (right - left) % width; i > 0; i--)                                        \
+    {                                                                                           \
+        if (goesLeft(arr[left], pivot, or_equal))                                               \
+            left++;                                                                             \
+        else                                                                                    \
+            std::swap(arr[left], arr[--right]);                                                 \
+    }                                                                                           \
+    if (right - left < 2 * width)                                                               \
+        return partitionScalar(arr, left, right, pivot, or_equal);                              \
+                                                                                                \
+    typename Ops::reg pivots = Ops::set1(pivot);                                                \
+    typename Ops::reg first = Ops::load(arr + left), last = Ops::load(arr + right - width);     \
+    int64_t l_store = left, r_store = right - width;                                            \
+    left += width;                                                                              \
+    right -= width;                                                                             \
+    while (left < right)                                                                        \
+    {                                                                                           \
+        /* Load from the side with less room, so both keep a vector's worth */                  \
+        typename Ops::reg v;                                                                    \
+        if (r_store + width - right < left - l_store)                                           \
+        {                                                                                       \
+            right -= width;                                                                     \
+            v = Ops::load(arr + right);                                                         \
+        }                                                                                       \
+        else                                                                                    \
+        {                                                                                       \
+            v = Ops::load(arr + left);                                                          \
+            left += width;                                                                      \
+        }                                                                                       \
+        int count = Ops::storeSplit(arr + l_store, arr + r_store, v, Ops::leftMask(v, pivots, or_equal)); \
+        l_store += count;                                                                       \
+        r_store -= width - count;                                                               \
+    }                                                                                           \
+    int count = Ops::storeSplit(arr + l_store, arr + r_store, first, Ops::leftMask(first, pivots, or_equal)); \
+    l_store += count;                                                                           \
+    r_store -= width - count;                                                                   \
+    count = Ops::storeSplit(arr + l_store, arr + r_store, last, Ops::leftMask(last, pivots, or_equal)); \
+    return l_store + count;                                                                     \
+}
+
+SORTIK_VECTOR_PARTITION(SORTIK_TARGET_AVX2, partitionAVX2)
+SORTIK_VECTOR_PARTITION(SORTIK_TARGET_AVX512, partitionAVX512)
+#undef SORTIK_VECTOR_PARTITION
+#endif
+
+// int keys get the sorting networks at the bottom, other keys insertion sort
+inline void quickBase(int32_t* arr, int number) { sortSmall(arr, number); }
+
+template <typename T>
+void quickBase(T* arr, int number)
+{
+    for (int i = 1; i < number; i++)
+    {
+        T temp = arr[i];
+        int j = i;
+        for (; j > 0 && temp < arr[j - 1]; j--)
+            arr[j] = arr[j - 1];
+        arr[j] = temp;
+    }
+}
+
+// Only int arrays are ever on screen
+inline void notePartition(const int32_t* base, const int32_t* arr, int64_t number)
+{
+    if (!trace_recorder && !dirty_blocks)
+        return;
+    for (int64_t i = 0; i < number; i++)
+        noteWrite((int)(arr - base + i), arr[i]);
+}
+
+template <typename T>
+void notePartition(const T*, const T*, int64_t) {}
+
+template <typename T>
+T choosePivot(const T* arr, int64_t number)
+{
+    T samples[9];
+    for (int s = 0; s < 9; s++)
+        samples[s] = arr[(number - 1) * s / 8];
+    quickBase(samples, 9);
+    return samples[4];
+}
+
+const int quick_base_max = 32;
+
+template <typename T>
+void quickSortLoop(T* base, T* arr, int64_t number, int depth, int64_t (*partition)(T*, int64_t, int64_t, T, bool), std::atomic<int>* oper_count)
+{
+    while (number > quick_base_max)
+    {
+        // Bad pivots for too long, let introsort finish it
+        if (depth-- == 0)
+        {
+            std::sort(arr, arr + number);
+            notePartition(base, arr, number);
+            return;
+        }
+        T pivot = choosePivot(arr, number);
+        int64_t split = partition(arr, 0, number, pivot, false);
+        if (split == 0)
+        {
+            // Nothing is below the pivot, so it's the minimum and its copies are done
+            split = partition(arr, 0, number, pivot, true);
+            notePartition(base, arr, number);
+            arr += split;
+            number -= split;
+            continue;
+        }
+        notePartition(base, arr, number);
+        if (oper_count)
+            *oper_count += (int)number;
+
+        // Recurse into the smaller side and loop on the larger one, the stack stays O(log n)
+        if (split < number - split)
+        {
+            quickSortLoop(base, arr, split, depth, partition, oper_count);
+            arr += split;
+            number -= split;
+        }
+        else
+        {
+            quickSortLoop(base, arr + split, number - split, depth, partition, oper_count);
+            number = split;
+        }
+    }
+    quickBase(arr, (int)number);
+    notePartition(base, arr, number);
+}
+
+// base is where index 0 of the on-screen array lives when arr is only a slice of it
+template <typename T>
+void vectorQuickSort(T* arr, int64_t number, std::atomic<int>* oper_count = nullptr, T* base = nullptr)
+{
+    if (number < 2)
+        return;
+    if (!base)
+        base = arr;
+    int depth = 4;
+    for (int64_t n = number; n > 1; n >>= 1)
+        depth += 2;
+#ifdef SORTIK_X86
+    if (simd_level >= SimdLevel_AVX512)
+    {
+        quickSortLoop(base, arr, number, depth, partitionAVX512<typename QuickOps<T>::AVX512>, oper_count);
+        return;
+    }
+    if (simd_level >= SimdLevel_AVX2)
+    {
+        quickSortLoop(base, arr, number, depth, partitionAVX2<typename QuickOps<T>::AVX2>, oper_count);
+        return;
+    }
+#endif
+    // A scalar partition loses to introsort, so there's no point going through the loop
+    std::sort(arr, arr + number);
+    notePartition(base, arr, number);
+    if (oper_count)
+        *oper_count += (int)number;
+}
+
+void vectorQuickSortEngine(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    vectorQuickSort(array, (int64_t)number, &oper_count);
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+//------MSD RADIX------------------------------------------------------------------
+//
+// In-place most-significant-digit radix sort (American flag sort): count the
+// current byte, then cycle every key straight into its bucket, then recurse into
+// each bucket on the next byte. Bytes above the first one where the smallest and
+// largest keys differ are skipped, and buckets small enough that a whole radix
+// pass would be wasted go to the vector quicksort instead.
+
+const int msd_comparison_cutoff = 256;
+const int msd_parallel_threshold = 1 << 16;
+
+// How many keys landed on each digit, summed over every bucket of a level.
+// Level 0 is the first byte that actually differs between keys.
+struct MsdOccupancy
+{
+    static const int levels = 8;                     // enough for 64-bit keys
+    std::atomic<long long> counts[levels][256];
+    std::atomic<int> deepest{-1};                    // -1 until a pass has run
+
+    void reset()
+    {
+        for (int level = 0; level < levels; level++)
+            for (int digit = 0; digit < 256; digit++)
+                counts[level][digit].store(0, std::memory_order_relaxed);
+        deepest = -1;
+    }
+
+    void record(int level, const int64_t* starts)
+    {
+        for (int digit = 0; digit < 256; digit++)
+            if (starts[digit + 1] != starts[digit])
+                counts[level][digit].fetch_add(starts[digit + 1] - starts[digit], std::memory_order_relaxed);
+        int seen = deepest.load();
+        while (seen < level && !deepest.compare_exchange_weak(seen, level)) {}
+    }
+};
+
+MsdOccupancy msd_occupancy;
+
+// Keys are ordered as unsigned once the sign bit is flipped, so negatives come first
+template <typename T>
+inline typename std::make_unsigned<T>::type msdBits(T key)
+{
+    typedef typename std::make_unsigned<T>::type U;
+    return (U)key ^ ((U)1 << (sizeof(T) * 8 - 1));
+}
+
+template <typename T>
+inline unsigned msdDigit(T key, int shift)
+{
+    return (unsigned)(msdBits(key) >> shift) & 0xFF;
+}
+
+// One American flag pass on the byte at shift, bucket b ends up in [starts[b], starts[b + 1]).
+// Returns false when every key had the same byte and nothing had to move.
+template <typename T>
+bool americanFlagPass(T* arr, int64_t number, int shift, int64_t* starts)
+{
+    int64_t heads[256], tails[256];
+    int64_t counts[256] = {};
+    for (int64_t i = 0; i < number; i++)
+        counts[msdDigit(arr[i], shift)]++;
+    int64_t sum = 0;
+    for (int digit = 0; digit < 256; digit++)
+    {
+        starts[digit] = heads[digit] = sum;
+        sum += counts[digit];
+        tails[digit] = sum;
+    }
+    starts[256] = number;
+    if (counts[msdDigit(arr[0], shift)] == number)
+        return false;
+
+    for (unsigned digit = 0; digit < 256; digit++)
+    {
+        while (heads[digit] < tails[digit])
+        {
+            // Carry the key along its cycle until one belongs where this one came from
+            T value = arr[heads[digit]];
+            unsigned target = msdDigit(value, shift);
+            while (target != digit)
+            {
+                std::swap(value, arr[heads[target]++]);
+                target = msdDigit(value, shift);
+            }
+            arr[heads[digit]++] = value;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+void americanFlagSort(T* base, T* arr, int64_t number, int shift, int level, MsdOccupancy* occupancy, std::atomic<int>* oper_count)
+{
+    if (number < 2)
+        return;
+    if (number <= msd_comparison_cutoff)
+    {
+        vectorQuickSort(arr, number, oper_count, base);
+        return;
+    }
+    int64_t starts[257];
+    if (americanFlagPass(arr, number, shift, starts))
+        notePartition(base, arr, number);
+    if (oper_count)
+        *oper_count += (int)number;
+    if (occupancy && level < MsdOccupancy::levels)
+        occupancy->record(level, starts);
+    if (shift == 0)
+        return;
+    for (int digit = 0; digit < 256; digit++)
+        americanFlagSort(base, arr + starts[digit], starts[digit + 1] - starts[digit], shift - 8, level + 1, occupancy, oper_count);
+}
+
+inline void msdKeyRange(const int32_t* arr, int64_t number, int32_t& min, int32_t& max) { keyRange(arr, (int)number, min, max); }
+
+template <typename T>
+void msdKeyRange(const T* arr, int64_t number, T& min, T& max)
+{
+    auto range = std::minmax_element(arr, arr + number);
+    min = *range.first;
+    max = *range.second;
+}
+
+template <typename T>
+void msdRadixSort(T* arr, int64_t number, MsdOccupancy* occupancy = nullptr, std::atomic<int>* oper_count = nullptr)
+{
+    if (number < 2)
+        return;
+    if (number <= msd_comparison_cutoff)
+    {
+        vectorQuickSort(arr, number, oper_count);
+        return;
+    }
+
+    // Every byte above the highest one where min and max differ is shared by all keys
+    T min, max;
+    msdKeyRange(arr, number, min, max);
+    if (oper_count)
+        *oper_count += (int)number;
+    auto spread = msdBits(min) ^ msdBits(max);
+    if (spread == 0)
+        return;
+    int top = 0;
+    while (spread >> 8)
+    {
+        spread >>= 8;
+        top += 8;
+    }
+
+    int64_t starts[257];
+    americanFlagPass(arr, number, top, starts);
+    notePartition(arr, arr, number);
+    if (oper_count)
+        *oper_count += (int)number;
+    if (occupancy)
+        occupancy->record(0, starts);
+    if (top == 0)
+        return;
+
+    // The top-level buckets are independent, so idle cores take them off a shared counter.
+    // A trace has to stay in one order, so recording keeps it on this thread.
+    int workers = number >= msd_parallel_threshold && !trace_recorder ? (int)std::min(16u, std::max(1u, std::thread::hardware_concurrency())) : 1;
+    runTasks(256, workers, [&](int digit)
+    {
+        americanFlagSort(arr, arr + starts[digit], starts[digit + 1] - starts[digit], top - 8, 1, occupancy, oper_count);
+    });
+}
+
+void msdRadixSortEngine(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // Benchmark workers run side by side, only the on-screen sort fills in the occupancy plot
+    MsdOccupancy* occupancy = bench_worker ? nullptr : &msd_occupancy;
+    if (occupancy)
+        occupancy->reset();
+    msdRadixSort(array, (int64_t)number, occupancy, &oper_count);
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+//------STABLE MERGE---------------------------------------------------------------
+//
+// Merge sort that keeps equal keys in their original order, for records sorted
+// on one field. Insertion sort makes runs of 32, then every merge pass is cut
+// into equal slices of output with merge path (co-ranking), so each core gets
+// the same amount of work however long the runs being merged are. The scratch
+// array is borrowed from a pool that keeps its buffers between sorts.
+// The in-place variant needs no scratch at all: it merges by rotating blocks,
+// which costs O(n log^2 n) moves instead of O(n log n).
+
+const int stable_run = 32;
+const int merge_parallel_threshold = 1 << 16;
+const int64_t merge_slice_min = 1 << 14;
+
+inline int mergeWorkers(int64_t number)
+{
+    // A trace has to stay in one order, so recording keeps everything on this thread
+    if (number < merge_parallel_threshold || trace_recorder)
+        return 1;
+    return (int)std::min(16u, std::max(1u, std::thread::hardware_concurrency()));
+}
+
+template <typename T, typename Less>
+void insertionSortRun(T* arr, int64_t number, Less less)
+{
+    for (int64_t i = 1; i < number; i++)
+    {
+        T temp = arr[i];
+        int64_t j = i;
+        for (; j > 0 && less(temp, arr[j - 1]); j--)
+            arr[j] = arr[j - 1];
+        arr[j] = temp;
+    }
+}
+
+// How many of the first k merged keys come from a. Ties go to a, which is what keeps it stable.
+template <typename T, typename Less>
+int64_t coRank(int64_t k, const T* a, int64_t na, const T* b, int64_t nb, Less less)
+{
+    int64_t low = std::max<int64_t>(0, k - nb), high = std::min(k, na);
+    while (low < high)
+    {
+        int64_t i = low + (high - low) / 2, j = k - i;
+        // a[i] not after b[j - 1] means it belongs in the first k too
+        if (j > 0 && !less(b[j - 1], a[i]))
+            low = i + 1;
+        else
+            high = i;
+    }
+    return low;
+}
+
+template <typename T, typename Less>
+void mergeStable(const T* a, int64_t na, const T* b, int64_t nb, T* out, Less less)
+{
+    int64_t i = 0, j = 0;
+    while (i < na && j < nb)
+        *out++ = less(b[j], a[i]) ? b[j++] : a[i++];
+    out = std::copy(a + i, a + na, out);
+    std::copy(b + j, b + nb, out);
+}
+
+// One slice of a merge pass, offsets into the source and destination arrays
+struct MergeSlice
+{
+    int64_t a, na, b, nb, out;
+};
+
+template <typename T, typename Less = std::less<T>>
+void stableMergeSort(T* arr, int64_t number, Less less = Less(), std::atomic<int>* oper_count = nullptr)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "the scratch pool hands out raw bytes");
+    if (number < 2)
+        return;
+    int workers = mergeWorkers(number);
+
+    int runs = (int)((number + stable_run - 1) / stable_run);
+    runTasks(runs, workers, [&](int run)
+    {
+        int64_t begin = (int64_t)run * stable_run, count = std::min<int64_t>(stable_run, number - begin);
+        insertionSortRun(arr + begin, count, less);
+        notePartition(arr, arr + begin, count);
+    });
+    if (oper_count)
+        *oper_count += (int)number;
+
+    ScratchPool::Lease scratch = scratch_pool.borrow((size_t)number * sizeof(T));
+    T* from = arr;
+    T* to = scratch.as<T>();
+    std::vector<MergeSlice> slices;
+    int64_t slice_size = std::max(merge_slice_min, number / (workers * 4));
+    for (int64_t width = stable_run; width < number; width *= 2)
+    {
+        // Long merges are cut where merge path says, so the slices are independent
+        slices.clear();
+        for (int64_t begin = 0; begin < number; begin += 2 * width)
+        {
+            int64_t middle = std::min(begin + width, number), end = std::min(begin + 2 * width, number);
+            const T* a = from + begin;
+            const T* b = from + middle;
+            int64_t na = middle - begin, nb = end - middle;
+            int64_t pieces = (na + nb + slice_size - 1) / slice_size;
+            int64_t previous = 0;
+            for (int64_t piece = 1; piece <= pieces; piece++)
+            {
+                int64_t k_begin = (na + nb) * (piece - 1) / pieces, k_end = (na + nb) * piece / pieces;
+                int64_t next = coRank(k_end, a, na, b, nb, less);
+                slices.push_back({ begin + previous, next - previous, middle + k_begin - previous, (k_end - next) - (k_begin - previous), begin + k_begin });
+                previous = next;
+            }
+        }
+        runTasks((int)slices.size(), workers, [&](int s)
+        {
+            const MergeSlice& slice = slices[s];
+            mergeStable(from + slice.a, slice.na, from + slice.b, slice.nb, to + slice.out, less);
+            if (to == arr)
+                notePartition(arr, arr + slice.out, slice.na + slice.nb);
+        });
+        if (oper_count)
+            *oper_count += (int)number;
+        std::swap(from, to);
+        std::this_thread::yield();
+    }
+    if (from != arr)
+    {
+        std::copy(from, from + number, arr);
+        notePartition(arr, arr, number);
+        if (oper_count)
+            *oper_count += (int)number;
+    }
+}
+
+// Stable merge of [first, middle) and [middle, last) with no buffer: split the
+// longer run in half, find where its middle key lands in the other one, rotate
+// the two inner blocks past each other and merge both sides the same way
+template <typename T, typename Less>
+T* splitInPlaceMerge(T* first, T* middle, T* last, Less less, T*& cut1, T*& cut2)
+{
+    if (middle - first > last - middle)
+    {
+        cut1 = first + (middle - first) / 2;
+        cut2 = std::lower_bound(middle, last, *cut1, less);
+    }
+    else
+    {
+        cut2 = middle + (last - middle) / 2;
+        cut1 = std::upper_bound(first, middle, *cut2, less);
+    }
+    return std::rotate(cut1, middle, cut2);
+}
+
+template <typename T, typename Less>
+void mergeInPlace(T* first, T* middle, T* last, Less less)
+{
+    if (first == middle || middle == last || !less(*middle, *(middle - 1)))
+        return;
+    if (last - first == 2)
+    {
+        std::swap(*first, *middle);
+        return;
+    }
+    T* cut1;
+    T* cut2;
+    T* new_middle = splitInPlaceMerge(first, middle, last, less, cut1, cut2);
+    mergeInPlace(first, cut1, new_middle, less);
+    mergeInPlace(new_middle, cut2, last, less);
+}
+
+template <typename T>
+struct InPlaceMerge
+{
+    T* first;
+    T* middle;
+    T* last;
+};
+
+template <typename T, typename Less = std::less<T>>
+void inPlaceMergeSort(T* arr, int64_t number, Less less = Less(), std::atomic<int>* oper_count = nullptr)
+{
+    if (number < 2)
+        return;
+    int workers = mergeWorkers(number);
+
+    int runs = (int)((number + stable_run - 1) / stable_run);
+    runTasks(runs, workers, [&](int run)
+    {
+        int64_t begin = (int64_t)run * stable_run, count = std::min<int64_t>(stable_run, number - begin);
+        insertionSortRun(arr + begin, count, less);
+        notePartition(arr, arr + begin, count);
+    });
+    if (oper_count)
+        *oper_count += (int)number;
+
+    std::vector<InPlaceMerge<T>> merges;
+    int64_t slice_size = std::max(merge_slice_min, number / (workers * 4));
+    for (int64_t width = stable_run; width < number; width *= 2)
+    {
+        merges.clear();
+        for (int64_t begin = 0; begin < number; begin += 2 * width)
+        {
+            int64_t middle = std::min(begin + width, number), end = std::min(begin + 2 * width, number);
+            merges.push_back({ arr + begin, arr + middle, arr + end });
+        }
+        // Few long merges near the top: split them here until there's a slice per core
+        for (size_t m = 0; workers > 1 && m < merges.size() && (int)merges.size() < workers * 4; m++)
+        {
+            InPlaceMerge<T> merge = merges[m];
+            if (merge.last - merge.first <= slice_size || merge.first == merge.middle || merge.middle == merge.last)
+                continue;
+            T* cut1;
+            T* cut2;
+            T* new_middle = splitInPlaceMerge(merge.first, merge.middle, merge.last, less, cut1, cut2);
+            merges[m] = { merge.first, cut1, new_middle };
+            merges.push_back({ new_middle, cut2, merge.last });
+            m--;
+        }
+        runTasks((int)merges.size(), workers, [&](int m)
+        {
+            const InPlaceMerge<T>& merge = merges[m];
+            mergeInPlace(merge.first, merge.middle, merge.last, less);
+            notePartition(arr, merge.first, merge.last - merge.first);
+        });
+        if (oper_count)
+            *oper_count += (int)number;
+        std::this_thread::yield();
+    }
+}
+
+// Sorts records on a key with few distinct values, then checks equal keys kept their order
+struct StabilityRecord
+{
+    int key;
+    int index;
+};
+
+template <typename Sort>
+bool checkStability(Sort sort)
+{
+    const int number = 300000;
+    std::vector<StabilityRecord> records(number);
+    std::mt19937 random(number);
+    for (int i = 0; i < number; i++)
+        records[i] = { (int)(random() % 64), i };
+    sort(records.data(), (int64_t)number, [](const StabilityRecord& a, const StabilityRecord& b) { return a.key < b.key; });
+    for (int i = 1; i < number; i++)
+    {
+        const StabilityRecord& left = records[i - 1];
+        const StabilityRecord& right = records[i];
+        if (left.key > right.key || (left.key == right.key && left.index > right.index))
+            return false;
+    }
+    return true;
+}
+
+bool stableMergeIsStable()
+{
+    return checkStability([](StabilityRecord* arr, int64_t number, auto less) { stableMergeSort(arr, number, less); });
+}
+
+bool inPlaceMergeIsStable()
+{
+    return checkStability([](StabilityRecord* arr, int64_t number, auto less) { inPlaceMergeSort(arr, number, less); });
+}
+
+void stableMergeSortEngine(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    stableMergeSort(array, (int64_t)number, std::less<int>(), &oper_count);
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+void inPlaceMergeSortEngine(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    inPlaceMergeSort(array, (int64_t)number, std::less<int>(), &oper_count);
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+//------TIMSORT--------------------------------------------------------------------
+//
+// Natural merge sort for input that is mostly in order already. It walks the
+// array once cutting it into the runs that are there (descending ones get
+// reversed, short ones get topped up with insertion sort), and merges them as
+// it goes with the powersort policy: a run boundary's power is how deep it sits
+// in a perfectly balanced merge tree, and deeper boundaries are merged first.
+// When one side of a merge keeps winning, it switches to galloping and moves a
+// whole block found by exponential search instead of one key at a time, so a
+// few long runs merge in close to O(n). Stable, like the rest of merge sort.
+
+// Counted over one sort: what the input looked like and how often galloping paid off
+struct TimMetrics
+{
+    long long runs = 0;              // natural runs, counting the short ones topping up swallowed
+    long long galloping = 0;         // times a merge switched into galloping mode
+    long long gallop_hits = 0;       // gallops that moved more than one key
+    long long galloped_keys = 0;     // keys moved by galloping instead of one by one
+};
+
+std::mutex tim_metrics_mutex;
+TimMetrics tim_metrics;              // last on-screen tim run
+
+const int tim_min_gallop = 7;
+
+// Runs shorter than this get topped up, it keeps n / minrun close to a power of two
+inline int64_t timMinRun(int64_t number)
+{
+    int64_t extra = 0;
+    while (number >= 64)
+    {
+        extra |= number & 1;
+        number >>= 1;
+    }
+    return number + extra;
+}
+
+// Length of the run at arr, a strictly descending one is reversed so it ascends
+template <typename T, typename Less>
+int64_t timCountRun(T* arr, int64_t number, Less less)
+{
+    if (number < 2)
+        return number;
+    int64_t end = 2;
+    if (less(arr[1], arr[0]))
+    {
+        // Strictly, or reversing would swap equal keys
+        while (end < number && less(arr[end], arr[end - 1]))
+            end++;
+        std::reverse(arr, arr + end);
+    }
+    else
+    {
+        while (end < number && !less(arr[end], arr[end - 1]))
+            end++;
+    }
+    return end;
+}
+
+// Exponential search from one end, then binary search within the last step.
+// lower: first key not before key. upper: first key after key.
+template <typename T, typename Less>
+int64_t gallopLower(const T& key, const T* arr, int64_t number, Less less)
+{
+    int64_t low = 0, step = 1;
+    while (step <= number && less(arr[step - 1], key))
+    {
+        low = step;
+        step = step * 2 + 1;
+    }
+    return std::lower_bound(arr + low, arr + std::min(step, number), key, less) - arr;
+}
+
+template <typename T, typename Less>
+int64_t gallopUpper(const T& key, const T* arr, int64_t number, Less less)
+{
+    int64_t low = 0, step = 1;
+    while (step <= number && !less(key, arr[step - 1]))
+    {
+        low = step;
+        step = step * 2 + 1;
+    }
+    return std::upper_bound(arr + low, arr + std::min(step, number), key, less) - arr;
+}
+
+template <typename T, typename Less>
+int64_t gallopLowerBack(const T& key, const T* arr, int64_t number, Less less)
+{
+    int64_t high = number, step = 1;
+    while (step <= number && !less(arr[number - step], key))
+    {
+        high = number - step;
+        step = step * 2 + 1;
+    }
+    int64_t low = step <= number ? number - step + 1 : 0;
+    return std::lower_bound(arr + low, arr + high, key, less) - arr;
+}
+
+template <typename T, typename Less>
+int64_t gallopUpperBack(const T& key, const T* arr, int64_t number, Less less)
+{
+    int64_t high = number, step = 1;
+    while (step <= number && less(key, arr[number - step]))
+    {
+        high = number - step;
+        step = step * 2 + 1;
+    }
+    int64_t low = step <= number ? number - step + 1 : 0;
+    return std::upper_bound(arr + low, arr + high, key, less) - arr;
+}
+
+template <typename T, typename Less>
+struct TimState
+{
+    T*          base;                // whole array, for the chart
+    T*          scratch;             // room for half the array
+    Less        less;
+    int         min_gallop = tim_min_gallop;
+    TimMetrics  metrics;
+};
+
+// Merges a[0, na) with the run right after it, na <= nb. Copies a out and fills from the front.
+template <typename T, typename Less>
+void timMergeLow(TimState<T, Less>& state, T* a, int64_t na, int64_t nb)
+{
+    Less& less = state.less;
+    T* left = state.scratch;
+    T* right = a + na;
+    T* out = a;
+    std::copy(a, a + na, left);
+    int64_t l = 0, r = 0;
+    while (l < na && r < nb)
+    {
+        // One key at a time until a side wins min_gallop times in a row
+        int left_wins = 0, right_wins = 0;
+        while (l < na && r < nb && left_wins < state.min_gallop && right_wins < state.min_gallop)
+        {
+            if (less(right[r], left[l]))
+            {
+                *out++ = right[r++];
+                right_wins++;
+                left_wins = 0;
+            }
+            else
+            {
+                *out++ = left[l++];
+                left_wins++;
+                right_wins = 0;
+            }
+        }
+        if (l == na || r == nb)
+            break;
+
+        // Galloping, for as long as the blocks it finds are long enough to be worth it
+        state.metrics.galloping++;
+        int64_t left_block, right_block;
+        do
+        {
+            state.min_gallop -= state.min_gallop > 1;
+            left_block = gallopUpper(right[r], left + l, na - l, less);
+            out = std::copy(left + l, left + l + left_block, out);
+            l += left_block;
+            if (l == na)
+                break;
+            *out++ = right[r++];
+            if (r == nb)
+                break;
+            right_block = gallopLower(left[l], right + r, nb - r, less);
+            out = std::copy(right + r, right + r + right_block, out);
+            r += right_block;
+            if (r == nb)
+                break;
+            *out++ = left[l++];
+            if (l == na)
+                break;
+            state.metrics.gallop_hits += (left_block > 1) + (right_block > 1);
+            state.metrics.galloped_keys += left_block + right_block;
+        } while (left_block >= tim_min_gallop || right_block >= tim_min_gallop);
+        state.min_gallop += 2;
+    }
+    // Whatever is left of the right run is in place already
+    std::copy(left + l, left + na, out);
+}
+
+// Merges a[0, na) with the run right after it, na > nb. Copies that run out and fills from the back.
+template <typename T, typename Less>
+void timMergeHigh(TimState<T, Less>& state, T* a, int64_t na, int64_t nb)
+{
+    Less& less = state.less;
+    T* right = state.scratch;
+    T* out = a + na + nb;
+    std::copy(a + na, a + na + nb, right);
+    int64_t l = na, r = nb;          // keys left in each run
+    while (l > 0 && r > 0)
+    {
+        int left_wins = 0, right_wins = 0;
+        while (l > 0 && r > 0 && left_wins < state.min_gallop && right_wins < state.min_gallop)
+        {
+            if (less(right[r - 1], a[l - 1]))
+            {
+                *--out = a[--l];
+                left_wins++;
+                right_wins = 0;
+            }
+            else
+            {
+                *--out = right[--r];
+                right_wins++;
+                left_wins = 0;
+            }
+        }
+        if (l == 0 || r == 0)
+            break;
+
+        state.metrics.galloping++;
+        int64_t left_block, right_block;
+        do
+        {
+            state.min_gallop -= state.min_gallop > 1;
+            left_block = l - gallopUpperBack(right[r - 1], a, l, less);
+            out = std::copy_backward(a + l - left_block, a + l, out);
+            l -= left_block;
+            if (l == 0)
+                break;
+            *--out = right[--r];
+            if (r == 0)
+                break;
+            right_block = r - gallopLowerBack(a[l - 1], right, r, less);
+            out = std::copy_backward(right + r - right_block, right + r, out);
+            r -= right_block;
+            if (r == 0)
+                break;
+            *--out = a[--l];
+            if (l == 0)
+                break;
+            state.metrics.gallop_hits += (left_block > 1) + (right_block > 1);
+            state.metrics.galloped_keys += left_block + right_block;
+        } while (left_block >= tim_min_gallop || right_block >= tim_min_gallop);
+        state.min_gallop += 2;
+    }
+    // Whatever is left of the left run is in place already
+    std::copy_backward(right, right + r, out);
+}
+
+template <typename T, typename Less>
+void timMerge(TimState<T, Less>& state, T* a, int64_t na, int64_t nb, std::atomic<int>* oper_count)
+{
+    // Keys of a below b's first one, and keys of b above a's last one, don't move
+    int64_t skip = gallopUpper(a[na], a, na, state.less);
+    a += skip;
+    na -= skip;
+    if (na > 0)
+        nb = gallopLower(a[na - 1], a + na, nb, state.less);
+    if (na > 0 && nb > 0)
+    {
+        if (na <= nb)
+            timMergeLow(state, a, na, nb);
+        else
+            timMergeHigh(state, a, na, nb);
+        notePartition(state.base, a, na + nb);
+        // Only what was left after trimming counts, in order input merges for free
+        if (oper_count)
+            *oper_count += (int)(na + nb);
+    }
+}
+
+// Depth of the boundary between runs [s1, s1 + n1) and [s1 + n1, s1 + n1 + n2) in the
+// balanced merge tree over n keys: the first bit where their midpoints, as fractions
+// of n, differ
+inline int powersortPower(int64_t s1, int64_t n1, int64_t n2, int64_t number)
+{
+    int power = 0;
+    int64_t a = 2 * s1 + n1, b = a + n1 + n2;
+    for (;;)
+    {
+        power++;
+        if (a >= number)
+        {
+            a -= number;
+            b -= number;
+        }
+        else if (b >= number)
+            break;
+        a <<= 1;
+        b <<= 1;
+    }
+    return power;
+}
+
+template <typename T, typename Less = std::less<T>>
+void timSort(T* arr, int64_t number, Less less = Less(), std::atomic<int>* oper_count = nullptr, TimMetrics* metrics = nullptr)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "the scratch pool hands out raw bytes");
+    if (number < 2)
+        return;
+    ScratchPool::Lease scratch = scratch_pool.borrow((size_t)(number / 2 + 1) * sizeof(T));
+    TimState<T, Less> state = { arr, scratch.as<T>(), less, tim_min_gallop, TimMetrics() };
+
+    struct Run
+    {
+        int64_t start, length;
+        int     power;           // of the boundary with the next run
+    };
+    std::vector<Run> stack;
+    int64_t min_run = timMinRun(number);
+    auto mergeTop = [&]()
+    {
+        Run& a = stack[stack.size() - 2];
+        const Run& b = stack.back();
+        timMerge(state, arr + a.start, a.length, b.length, oper_count);
+        a.length += b.length;
+        stack.pop_back();
+        std::this_thread::yield();
+    };
+
+    for (int64_t start = 0; start < number;)
+    {
+        int64_t length = timCountRun(arr + start, number - start, less);
+        state.metrics.runs++;
+        if (length < min_run)
+        {
+            int64_t extended = std::min(min_run, number - start);
+            for (int64_t i = start + length; i < start + extended; i++)
+                state.metrics.runs += less(arr[i], arr[i - 1]);
+            // Binary insertion saves compares, but the keys are mostly close to home so
+            // walking them back is faster
+            insertionSortRun(arr + start, extended, less);
+            length = extended;
+        }
+        notePartition(arr, arr + start, length);
+        if (oper_count)
+            *oper_count += (int)length;
+
+        if (!stack.empty())
+        {
+            int power = powersortPower(stack.back().start, stack.back().length, length, number);
+            while (stack.size() > 1 && stack[stack.size() - 2].power > power)
+                mergeTop();
+            stack.back().power = power;
+        }
+        stack.push_back({ start, length, 0 });
+        start += length;
+    }
+    while (stack.size() > 1)
+        mergeTop();
+
+    if (metrics)
+        *metrics = state.metrics;
+}
+
+void timSortEngine(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    TimMetrics metrics;
+    timSort(array, (int64_t)number, std::less<int>(), &oper_count, &metrics);
+    if (!bench_worker)
+    {
+        std::lock_guard<std::mutex> lock(tim_metrics_mutex);
+        tim_metrics = metrics;
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+bool timSortIsStable()
+{
+    return checkStability([](StabilityRecord* arr, int64_t number, auto less) { timSort(arr, number, less); });
+}
+
+//------SELECTION------------------------------------------------------------------
+//
+// Engines for when only the smallest k keys or the k-th one are wanted. They
+// can't take k through the engine signature, so it's set per thread in
+// select_k before they run. Afterwards:
+//  - partial, heap, radixsel: the k smallest keys are sorted at the front
+//  - nth: the k-th smallest is at k - 1, with no larger key before it and no
+//    smaller one after
+// and the rest of the array holds the other keys in no particular order.
+
+enum SelectKind
+{
+    Select_None,        // sorts everything
+    Select_Prefix,      // k smallest, sorted, at the front
+    Select_Nth          // k-th smallest in its place, partitioned around it
+};
+
+thread_local int select_k = 1000;
+
+inline int selectCount(int number) { return std::max(1, std::min(select_k, number)); }
+
+// std::partial_sort, as a baseline for the rest
+void partialSortEngine(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    if (number > 0)
+    {
+        std::partial_sort(array, array + selectCount(number), array + number);
+        notePartition(array, array, number);
+        oper_count += number;
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+void nthElementEngine(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    if (number > 0)
+    {
+        std::nth_element(array, array + selectCount(number) - 1, array + number);
+        notePartition(array, array, number);
+        oper_count += number;
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+// Moves heap[0] down until both children are smaller
+inline void siftDown(int* heap, int count, int value)
+{
+    int hole = 0;
+    for (int child = 1; child < count; child = 2 * hole + 1)
+    {
+        child += child + 1 < count && heap[child] < heap[child + 1];
+        if (!(value < heap[child]))
+            break;
+        heap[hole] = heap[child];
+        hole = child;
+    }
+    heap[hole] = value;
+}
+
+// One pass over the keys with a max-heap of the k smallest seen so far at the
+// front. Most keys only cost one compare against the heap's top, so it reads
+// the array like a stream and doesn't need it all at once.
+void heapTopKEngine(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    if (number > 0)
+    {
+        int k = selectCount(number);
+        std::make_heap(array, array + k);
+        int top = array[0];
+        for (int i = k; i < number; i++)
+        {
+            if (array[i] < top)
+            {
+                int value = array[i];
+                array[i] = top;
+                noteWrite(i, array[i]);
+                siftDown(array, k, value);
+                top = array[0];
+            }
+        }
+        oper_count += number - k;
+        std::sort_heap(array, array + k);
+        notePartition(array, array, k);
+        oper_count += k;
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+// The k-th smallest key (k counts from 1) one byte at a time: a histogram of the top
+// byte says which bucket holds it, then only that bucket's keys are looked at for the
+// next byte. below gets how many keys are smaller.
+int radixSelectKey(const int* array, int64_t number, int64_t k, int64_t& below)
+{
+    below = 0;
+    std::vector<int> candidates;
+    const int* keys = array;
+    int64_t count = number;
+    uint32_t prefix = 0;
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        int64_t histogram[256] = {};
+        for (int64_t i = 0; i < count; i++)
+            histogram[msdDigit(keys[i], shift)]++;
+        unsigned digit = 0;
+        while (k > histogram[digit])
+        {
+            k -= histogram[digit];
+            below += histogram[digit];
+            digit++;
+        }
+        prefix |= digit << shift;
+        if (shift == 0 || histogram[digit] == count)
+            continue;
+        // Narrow down to this bucket, a copy is smaller than the array from here on
+        std::vector<int> bucket;
+        bucket.reserve((size_t)histogram[digit]);
+        for (int64_t i = 0; i < count; i++)
+            if (msdDigit(keys[i], shift) == digit)
+                bucket.push_back(keys[i]);
+        candidates.swap(bucket);
+        keys = candidates.data();
+        count = (int64_t)candidates.size();
+    }
+    return (int)(prefix ^ 0x80000000u);
+}
+
+void radixSelectEngine(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    if (number > 0)
+    {
+        int k = selectCount(number);
+        int64_t below;
+        int pivot = radixSelectKey(array, number, k, below);
+        oper_count += 2 * number;
+
+        // Smaller keys to the front, then copies of the k-th until there are k
+        int front = 0;
+        for (int i = 0; i < number; i++)
+            if (array[i] < pivot)
+            {
+                std::swap(array[front], array[i]);
+                noteWrite(front, array[front]);
+                noteWrite(i, array[i]);
+                front++;
+            }
+        for (int i = front; i < number && front < k; i++)
+            if (array[i] == pivot)
+            {
+                std::swap(array[front], array[i]);
+                noteWrite(front, array[front]);
+                noteWrite(i, array[i]);
+                front++;
+            }
+        oper_count += number;
+        vectorQuickSort(array, (int64_t)k, &oper_count);
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+// What a selection engine must leave behind, see SelectKind
+bool verifySelection(const int* array, int number, int k, SelectKind kind)
+{
+    if (number == 0)
+        return true;
+    k = std::max(1, std::min(k, number));
+    int kth = array[k - 1];
+    for (int i = 0; i < k - 1; i++)
+        if (kind == Select_Prefix ? array[i + 1] < array[i] : kth < array[i])
+            return false;
+    for (int i = k; i < number; i++)
+        if (array[i] < kth)
+            return false;
+    return true;
+}
+
+//------AUTO-----------------------------------------------------------------------
+//
+// Looks at a sample of the input and hands it to whichever engine should do best:
+//  - insertion sort for tiny or nearly sorted arrays
+//  - counting sort for keys packed into a few times n values
+//  - radix sort when there are enough keys to pay for its passes, the byte-wise
+//    LSD engine once the array is larger than L2 and fewer passes matter more
+//  - vector quicksort for the rest, and for inputs full of duplicates, which its
+//    partitioning drops as whole runs while radix still pays every pass
+// The crossovers depend on the machine, so they are measured once and kept in
+// sortik_calibration.txt in the working directory.
+
+// Plain insertion sort, only reached through auto
+void insertionSort(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    for (int i = 1; i < number; i++)
+    {
+        int temp = array[i];
+        int j;
+        for (j = i; j > 0 && array[j - 1] > temp; j--)
+        {
+            array[j] = array[j - 1];
+            noteWrite(j, array[j]);
+            oper_count++;
+        }
+        if (j != i)
+        {
+            array[j] = temp;
+            noteWrite(j, temp);
+            oper_count++;
+        }
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+struct InputProfile
+{
+    int    number = 0;
+    int    min = 0;
+    int    max = 0;
+    double descent_ratio = 0.0;   // sampled a[i] > a[i + 1], ~0 when presorted, ~0.5 when random
+    double duplicate_ratio = 0.0; // sampled keys equal to another sampled key
+    bool   sorted = false;
+};
+
+InputProfile profileInput(int* array, int number)
+{
+    InputProfile profile;
+    profile.number = number;
+    if (number < 2)
+    {
+        profile.sorted = true;
+        return profile;
+    }
+
+    // The key range has to be exact, radix and counting rely on it
+    keyRange(array, number, profile.min, profile.max);
+
+    // Neighbour pairs are cheap to look at, small arrays are checked whole
+    const int pairs = std::min(number - 1, 4096);
+    int descents = 0;
+    for (int s = 0; s < pairs; s++)
+    {
+        long long i = (long long)s * (number - 1) / pairs;
+        descents += array[i] > array[i + 1];
+    }
+    profile.descent_ratio = (double)descents / pairs;
+
+    // Duplicates need a sort of the sample, keep it to an eighth of the array
+    const int samples = std::max(1, std::min(number / 8, 1024));
+    std::vector<int> keys(samples);
+    for (int s = 0; s < samples; s++)
+        keys[s] = array[(long long)s * number / samples];
+    std::sort(keys.begin(), keys.end());
+    int duplicates = 0;
+    for (int s = 1; s < samples; s++)
+        duplicates += keys[s] == keys[s - 1];
+    profile.duplicate_ratio = (double)duplicates / samples;
+
+    // The sample can miss a few descents, only a full pass proves it sorted
+    if (descents == 0)
+        profile.sorted = verifyArrayIsSorted(array, number);
+    return profile;
+}
+
+// Falls back to 1 MiB where the OS won't tell
+long long cacheBytes()
+{
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (size > 0)
+        return size;
+#endif
+    return 1 << 20;
+}
+
+int decimalDigits(long long value)
+{
+    int digits = 1;
+    while (value >= 10)
+    {
+        value /= 10;
+        digits++;
+    }
+    return digits;
+}
+
+struct AutoTuning
+{
+    int    small_number = 32;          // insertion sort up to this size
+    double presorted_ratio = 0.001;    // insertion sort below this descent ratio
+    int    radix_number = 1 << 14;     // radix beats vector quicksort from here, keys 0..n-1
+    int    counting_range = 4;         // counting sort while keys span at most this times n
+};
+
+const char* auto_tuning_path = "sortik_calibration.txt";
+const int auto_tuning_version = 4;
+
+bool loadAutoTuning(const char* path, AutoTuning& tuning)
+{
+    FILE* file = fopen(path, "r");
+    if (!file)
+        return false;
+    int version = 0;
+    AutoTuning loaded;
+    bool ok = fscanf(file, "version %d\n", &version) == 1 && version == auto_tuning_version
+           && fscanf(file, "small_number %d\n", &loaded.small_number) == 1
+           && fscanf(file, "presorted_ratio %lf\n", &loaded.presorted_ratio) == 1
+           && fscanf(file, "radix_number %d\n", &loaded.radix_number) == 1
+           && fscanf(file, "counting_range %d\n", &loaded.counting_range) == 1;
+    fclose(file);
+    if (ok)
+        tuning = loaded;
+    return ok;
+}
+
+bool saveAutoTuning(const char* path, const AutoTuning& tuning)
+{
+    FILE* file = fopen(path, "w");
+    if (!file)
+        return false;
+    fprintf(file, "version %d\n", auto_tuning_version);
+    fprintf(file, "small_number %d\n", tuning.small_number);
+    fprintf(file, "presorted_ratio %g\n", tuning.presorted_ratio);
+    fprintf(file, "radix_number %d\n", tuning.radix_number);
+    fprintf(file, "counting_range %d\n", tuning.counting_range);
+    return fclose(file) == 0;
+}
+
+// Best of a few runs on a private copy, in ms
+double timeEngine(SortFunction sort, const std::vector<int>& input, int repeats)
+{
+    std::vector<int> work(input.size());
+    std::atomic<int> oper_count(0);
+    std::atomic<double> sort_time_ms(0.0);
+    bool was_bench_worker = bench_worker;
+    bench_worker = true;
+    double best = 1e300;
+    for (int r = 0; r < repeats; r++)
+    {
+        work = input;
+        auto start_time = std::chrono::high_resolution_clock::now();
+        sort(work.data(), (int)work.size(), oper_count, sort_time_ms);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end_time - start_time).count());
+    }
+    bench_worker = was_bench_worker;
+    return best;
+}
+
+// Takes well under a second, most of it on the presorted inputs
+AutoTuning calibrateAutoTuning()
+{
+    AutoTuning tuning;
+    std::mt19937 gen(12345);
+    auto permutation = [&](int number)
+    {
+        std::vector<int> input(number);
+        for (int i = 0; i < number; i++)
+            input[i] = i;
+        std::shuffle(input.begin(), input.end(), gen);
+        return input;
+    };
+
+    // Largest size where insertion sort still wins on random input
+    tuning.small_number = 0;
+    for (int number = 8; number <= 1024; number *= 2)
+    {
+        std::vector<int> input = permutation(number);
+        int repeats = std::max(3, 8192 / number);
+        double insertion = timeEngine(insertionSort, input, repeats);
+        double others = std::min(timeEngine(vectorQuickSortEngine, input, repeats), timeEngine(radixSort, input, repeats));
+        if (insertion > others)
+            break;
+        tuning.small_number = number;
+    }
+
+    // Size from which radix beats vector quicksort twice in a row, larger ones only
+    // widen the gap and would take most of the budget
+    tuning.radix_number = INT_MAX;
+    int radix_wins = 0;
+    for (int number = 8; number <= 1 << 20 && radix_wins < 2; number *= 2)
+    {
+        std::vector<int> input = permutation(number);
+        int repeats = std::max(1, (1 << 16) / number);
+        if (timeEngine(radixSort, input, repeats) < timeEngine(vectorQuickSortEngine, input, repeats))
+        {
+            if (radix_wins++ == 0)
+                tuning.radix_number = number;
+        }
+        else
+        {
+            radix_wins = 0;
+            tuning.radix_number = INT_MAX;
+        }
+    }
+
+    // Sorted arrays with random pairs swapped anywhere, the worst kind of
+    // "nearly sorted" for insertion sort, so the threshold errs on the safe side
+    const int number = 1 << 15;
+    SortFunction general = number >= tuning.radix_number ? radixSort : vectorQuickSortEngine;
+    tuning.presorted_ratio = 0.0;
+    for (int swaps = 1; swaps <= number / 16; swaps *= 2)
+    {
+        std::vector<int> input(number);
+        for (int i = 0; i < number; i++)
+            input[i] = i;
+        for (int s = 0; s < swaps; s++)
+            std::swap(input[gen() % number], input[gen() % number]);
+        int descents = 0;
+        for (int i = 0; i + 1 < number; i++)
+            descents += input[i] > input[i + 1];
+        if (timeEngine(insertionSort, input, 3) > timeEngine(general, input, 3))
+            break;
+        tuning.presorted_ratio = (double)descents / (number - 1);
+    }
+
+    // Widest key range, in multiples of n, where one histogram still beats the
+    // general engine. Capped, the histogram grows with it.
+    tuning.counting_range = 0;
+    for (int range = 1; range <= 16; range *= 2)
+    {
+        std::vector<int> input(number);
+        for (int i = 0; i < number; i++)
+            input[i] = (int)(gen() % ((unsigned)range * number));
+        auto counting = [](int* array, const int n, std::atomic<int>& oper_count, std::atomic<double>&)
+        {
+            countingSortRange(array, n, 0, (int)(*std::max_element(array, array + n)), oper_count);
+        };
+        if (timeEngine(counting, input, 3) > timeEngine(general, input, 3))
+            break;
+        tuning.counting_range = range;
+    }
+    return tuning;
+}
+
+std::mutex auto_tuning_mutex;
+
+// Loads the cached thresholds, or measures and caches them on first use
+const AutoTuning& autoTuning(bool recalibrate = false)
+{
+    static AutoTuning tuning;
+    static bool ready = false;
+    std::lock_guard<std::mutex> lock(auto_tuning_mutex);
+    if (ready && !recalibrate)
+        return tuning;
+    if (recalibrate || !loadAutoTuning(auto_tuning_path, tuning))
+    {
+        tuning = calibrateAutoTuning();
+        if (!saveAutoTuning(auto_tuning_path, tuning))
+            fprintf(stderr, "Can't write %s\n", auto_tuning_path);
+    }
+    ready = true;
+    return tuning;
+}
+
+// Sampled share of repeated keys from which vector quicksort takes over from radix
+const double auto_duplicate_ratio = 0.5;
+
+// Last path taken, for the UI and to log only when it changes
+std::mutex auto_choice_mutex;
+std::string auto_choice;
+
+void autoSort(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    oper_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    const AutoTuning& tuning = autoTuning();
+    InputProfile profile = profileInput(array, number);
+    long long cache = cacheBytes();
+    long long bytes = (long long)number * sizeof(int);
+
+    SortFunction sort = nullptr;
+    bool counting = false;  // needs the range, so it isn't a SortFunction
+    const char* name = "none";
+    char reason[128];
+    if (profile.sorted)
+        snprintf(reason, sizeof(reason), "already sorted");
+    else if (number <= tuning.small_number)
+    {
+        sort = insertionSort, name = "insertion";
+        snprintf(reason, sizeof(reason), "n <= %d", tuning.small_number);
+    }
+    else if (profile.descent_ratio <= tuning.presorted_ratio)
+    {
+        sort = insertionSort, name = "insertion";
+        snprintf(reason, sizeof(reason), "%.3f%% descents <= %.3f%%", profile.descent_ratio * 100.0, tuning.presorted_ratio * 100.0);
+    }
+    else if ((long long)profile.max - profile.min < (long long)tuning.counting_range * number)
+    {
+        counting = true, name = "counting";
+        snprintf(reason, sizeof(reason), "keys span %lld <= %dn", (long long)profile.max - profile.min + 1, tuning.counting_range);
+    }
+    else if (profile.duplicate_ratio >= auto_duplicate_ratio)
+    {
+        sort = vectorQuickSortEngine, name = "vquick";
+        snprintf(reason, sizeof(reason), "%.1f%% duplicates >= %.0f%%", profile.duplicate_ratio * 100.0, auto_duplicate_ratio * 100.0);
+    }
+    else
+    {
+        // Radix makes a pass per digit of key - min, wider keys need more of them to pay off
+        int passes = decimalDigits((long long)profile.max - profile.min);
+        long long needed = (long long)tuning.radix_number * passes / decimalDigits(number - 1);
+        bool radix = tuning.radix_number != INT_MAX && number >= needed;
+        bool cached = bytes <= cache;
+        if (!radix)
+            sort = vectorQuickSortEngine, name = "vquick";
+        else if (cached)
+            sort = radixSort, name = "radix";
+        else
+            sort = lsdRadixSortEngine<Scatter_Combining>, name = "lsd-wc";
+        if (tuning.radix_number == INT_MAX)
+            snprintf(reason, sizeof(reason), "radix never won calibration, %lld KiB vs %lld KiB L2", bytes >> 10, cache >> 10);
+        else
+            snprintf(reason, sizeof(reason), "n %s %lld for %d digit keys, %lld KiB %s %lld KiB L2",
+                     radix ? ">=" : "<", needed, passes, bytes >> 10, cached ? "<=" : ">", cache >> 10);
+    }
+
+    std::string choice = std::string(name) + ": " + reason;
+    {
+        std::lock_guard<std::mutex> lock(auto_choice_mutex);
+        if (choice != auto_choice)
+        {
+            fprintf(stderr, "auto: n=%d keys %d..%d, %.1f%% descents, %.1f%% duplicates -> %s\n",
+                    number, profile.min, profile.max, profile.descent_ratio * 100.0, profile.duplicate_ratio * 100.0, choice.c_str());
+            auto_choice = choice;
+        }
+    }
+
+    if (sort)
+        sort(array, number, oper_count, sort_time_ms);
+    else if (counting)
+        countingSortRange(array, number, profile.min, profile.max, oper_count);
+
+    // Count the sampling too
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    sort_time_ms = duration.count();
+}
+
+//---------------------------------------------------------------------------------
+
+// Runs any sort with the write hooks attached to the calling thread.
+// dirty may be null, an empty trace_path records nothing.
+void trackedSort(SortFunction sort, DirtyBlocks* dirty, std::string trace_path, int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    TraceRecorder recorder;
+    if (!trace_path.empty())
+    {
+        if (recorder.open(trace_path, array, number))
+            trace_recorder = &recorder;
+        else
+            fprintf(stderr, "Can't open trace file %s\n", trace_path.c_str());
+    }
+    dirty_blocks = dirty;
+
+    sort(array, number, oper_count, sort_time_ms);
+
+    dirty_blocks = nullptr;
+    trace_recorder = nullptr;
+    if (!recorder.close())
+        fprintf(stderr, "Error: writing trace file %s failed, it was removed\n", trace_path.c_str());
+}
+
+// trackedSort for a thread that still needs its k, selection engines read it from there
+void trackedSelect(int k, SortFunction sort, DirtyBlocks* dirty, std::string trace_path, int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+{
+    select_k = k;
+    trackedSort(sort, dirty, trace_path, array, number, oper_count, sort_time_ms);
+}
+
+bool isRunning(std::future<void>& future)
+{
+    return future.valid() && future.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+//------PICKED ENGINE--------------------------------------------------------------
+// The fourth window runs any engine from the benchmark list, picked in a combo
+DirtyBlocks picked_dirty;
+std::future<void> picked_future;
+std::atomic<int> picked_operations(0);
+std::atomic<double> picked_sort_time_ms(0.0);
+std::chrono::time_point<std::chrono::high_resolution_clock> picked_start_time;
+
+//---------------------------------------------------------------------------------
+//---------------------------------------------------------------------------------
+
+std::vector<int> downsampleArray(const int* data, int original_size) {
+    int max_points = 100000;
+    std::vector<int> downsampled;
+    if (original_size <= max_points) {
+        // No need to downsample
+        downsampled.assign(data, data + original_size);
+        return downsampled;
+    }
+    
+    // Calculate sampling rate
+    int step = original_size / max_points;
+    if (step < 1) step = 1;
+    
+    // Sample the data
+    downsampled.reserve(max_points);
+    for (int i = 0; i < original_size; i += step) {
+        downsampled.push_back(data[i]);
+    }
+    
+    return downsampled;
+}
+
+//------ARRAY TEXTURE--------------------------------------------------------------
+//
+// PlotBars emits a quad per bar, which stops scaling long before the sorts do.
+// ArrayTexture rasterizes an array into an SDL_Texture instead:
+//  - Dots:    column x holds indices [x*n/w, (x+1)*n/w), brightness is how many
+//             of them land on each value band
+//  - Heatmap: the array is laid out row by row, each pixel colored by the mean
+//             displacement |a[i] - i| of the indices it covers
+// Each frame only stripes (a column of dots or a row of the heatmap) that cover
+// a dirty block are rasterized. They are compared with what was uploaded last
+// time, and only the span of changed stripes is sent to the texture.
+
+enum ArrayView
+{
+    ArrayView_Bars,
+    ArrayView_Dots,
+    ArrayView_Heatmap,
+};
+
+class ArrayTexture
+{
+public:
+    // Only stripes covering a block in `dirty` are looked at
+    void update(SDL_Renderer* renderer, const int* array, int number, ArrayView view, const DirtySet& dirty)
+    {
+        if (!texture || number != texture_number || view != texture_view)
+            rebuild(renderer, number, view);
+        if (!texture || (!full_redraw && dirty.empty()))
+            return;
+        const long long n = number;
+
+        // Big arrays are split between a few threads, each with its own scratch
+        int workers = number >= parallel_threshold ? (int)scratch.size() : 1;
+        std::vector<int> first_dirty(workers, INT_MAX), last_dirty(workers, -1);
+        auto rasterize = [&](int worker)
+        {
+            auto markDirty = [&](int stripe_index)
+            {
+                first_dirty[worker] = std::min(first_dirty[worker], stripe_index);
+                last_dirty[worker] = std::max(last_dirty[worker], stripe_index);
+            };
+            if (view == ArrayView_Heatmap)
+            {
+                for (int y = height * worker / workers; y < height * (worker + 1) / workers; y++)
+                {
+                    long long first_cell = (long long)y * width, end_cell = std::min(cells, first_cell + width);
+                    if (!full_redraw && !dirty.any((int)(first_cell * n / cells), (int)(end_cell * n / cells)))
+                        continue;
+                    if (rasterizeRow(array, y, scratch[worker]))
+                        markDirty(y);
+                }
+            }
+            else
+            {
+                int blocks = (width + column_block - 1) / column_block;
+                for (int b = blocks * worker / workers; b < blocks * (worker + 1) / workers; b++)
+                {
+                    int x = b * column_block;
+                    int count = std::min(column_block, width - x);
+                    if (!full_redraw && !dirty.any((int)(x * n / width), (int)((x + count) * n / width)))
+                        continue;
+                    uint32_t changed = rasterizeColumns(array, x, count, scratch[worker]);
+                    for (int k = 0; changed; k++, changed >>= 1)
+                        if (changed & 1)
+                            markDirty(x + k);
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int w = 1; w < workers; w++)
+            threads.emplace_back(rasterize, w);
+        rasterize(0);
+        for (std::thread& thread : threads)
+            thread.join();
+
+        full_redraw = false;
+
+        int first = *std::min_element(first_dirty.begin(), first_dirty.end());
+        int last = *std::max_element(last_dirty.begin(), last_dirty.end());
+        if (last < 0)
+            return;
+
+        SDL_Rect rect;
+        const ImU32* first_pixel;
+        if (view == ArrayView_Heatmap)
+        {
+            rect = { 0, first, width, last - first + 1 };
+            first_pixel = &pixels[(size_t)first * width];
+        }
+        else
+        {
+            rect = { first, 0, last - first + 1, height };
+            first_pixel = &pixels[first];
+        }
+        SDL_UpdateTexture(texture, &rect, first_pixel, width * (int)sizeof(ImU32));
+    }
+
+    void draw(const ImVec2& size)
+    {
+        if (texture)
+            ImGui::Image((ImTextureID)(intptr_t)texture, size);
+    }
+
+    void destroy()
+    {
+        if (texture)
+            SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+
+    ~ArrayTexture() { destroy(); }
+
+private:
+    static constexpr int max_width = 1024;
+    static constexpr int max_height = 512;
+    static constexpr int column_block = 32;
+    static constexpr int parallel_threshold = 1 << 20;
+
+    struct Scratch
+    {
+        std::vector<ImU32>    stripe;
+        std::vector<uint32_t> counts;
+    };
+
+    SDL_Texture*          texture = nullptr;
+    int                   texture_number = 0;
+    ArrayView             texture_view = ArrayView_Bars;
+    int                   width = 0, height = 0;
+    long long             cells = 0;
+    bool                  full_redraw = true;
+    std::vector<ImU32>    pixels;   // what the texture currently holds
+    std::vector<Scratch>  scratch;  // one per rasterizing thread
+    std::vector<uint8_t>  levels;   // palette index for a dot count
+    ImU32                 palette[256];
+
+    void rebuild(SDL_Renderer* renderer, int number, ArrayView view)
+    {
+        destroy();
+        texture_number = number;
+        texture_view = view;
+        if (number <= 0 || view == ArrayView_Bars)
+            return;
+
+        if (view == ArrayView_Heatmap)
+        {
+            cells = std::min<long long>(number, (long long)max_width * max_height);
+            width = (int)std::min<long long>(cells, max_width);
+            height = (int)((cells + width - 1) / width);
+        }
+        else
+        {
+            width = std::min(number, max_width);
+            height = std::min(number, max_height);
+        }
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, width, height);
+        if (!texture)
+        {
+            SDL_Log("Error creating array texture: %s", SDL_GetError());
+            return;
+        }
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureScaleMode(texture, SDL_ScaleModeNearest);
+
+        for (int i = 0; i < 256; i++)
+            palette[i] = ImGui::ColorConvertFloat4ToU32(ImPlot::SampleColormap(i / 255.0f, ImPlotColormap_Viridis));
+        // Fill with a value no stripe produces so the first update sends everything
+        pixels.assign((size_t)width * height, 0x00FFFFFF);
+        full_redraw = true;
+        scratch.resize(std::min(8, std::max(1, (int)std::thread::hardware_concurrency())));
+        for (Scratch& worker_scratch : scratch)
+        {
+            worker_scratch.stripe.resize(width);
+            worker_scratch.counts.resize((size_t)column_block * height);
+        }
+
+        // Log scale, so a single dot is still visible next to a saturated band
+        int per_column = (number + width - 1) / width;
+        levels.resize(per_column + 1);
+        for (int c = 0; c <= per_column; c++)
+            levels[c] = (uint8_t)(64 + 191.0f * std::log(1.0f + c) / std::log(1.0f + per_column));
+    }
+
+    bool rasterizeRow(const int* array, int y, Scratch& scratch)
+    {
+        std::vector<ImU32>& stripe = scratch.stripe;
+        const long long number = texture_number;
+        // Cell c covers [c*n/cells, (c+1)*n/cells), walked without a division per cell
+        const long long step = number / cells, remainder = number % cells;
+        long long cell = (long long)y * width;
+        long long fraction = cell * number % cells;
+        int end = (int)(cell * number / cells);
+        // A random permutation averages n/3, so n/2 keeps it off the top of the palette
+        const double scale = 255.0 / (number / 2.0 + 1.0);
+        for (int x = 0; x < width; x++, cell++)
+        {
+            if (cell >= cells)
+            {
+                stripe[x] = 0;
+                continue;
+            }
+            int begin = end;
+            end += (int)step;
+            fraction += remainder;
+            if (fraction >= cells)
+            {
+                fraction -= cells;
+                end++;
+            }
+            long long displacement = 0;
+            for (int i = begin; i < end; i++)
+                displacement += std::llabs((long long)array[i] - i);
+            stripe[x] = palette[std::min(255, (int)((double)displacement / (end - begin) * scale))];
+        }
+        ImU32* row = &pixels[(size_t)y * width];
+        if (memcmp(row, stripe.data(), width * sizeof(ImU32)) == 0)
+            return false;
+        memcpy(row, stripe.data(), width * sizeof(ImU32));
+        return true;
+    }
+
+    // Dots are done a block of columns at a time so pixel rows are written
+    // in whole cache lines. Returns a bit per column of the block that changed.
+    uint32_t rasterizeColumns(const int* array, int first, int count, Scratch& scratch)
+    {
+        std::vector<uint32_t>& counts = scratch.counts;
+        const long long number = texture_number;
+        // 32.32 fixed point instead of a division per element
+        const uint64_t scale = ((uint64_t)height << 32) / (uint64_t)number;
+        const uint32_t last = height - 1;
+        std::fill(counts.begin(), counts.begin() + (size_t)count * height, 0u);
+        for (int k = 0; k < count; k++)
+        {
+            uint32_t* column = &counts[(size_t)k * height];
+            long long begin = (long long)(first + k) * number / width, end = (long long)(first + k + 1) * number / width;
+            for (long long i = begin; i < end; i++)
+            {
+                uint32_t band = (uint32_t)(((uint64_t)(uint32_t)array[i] * scale) >> 32);
+                column[last - std::min(band, last)]++;
+            }
+        }
+
+        uint32_t changed = 0;
+        for (int y = 0; y < height; y++)
+        {
+            ImU32* row = &pixels[(size_t)y * width + first];
+            for (int k = 0; k < count; k++)
+            {
+                uint32_t dots = counts[(size_t)k * height + y];
+                ImU32 color = dots ? palette[levels[dots]] : 0;
+                if (row[k] != color)
+                {
+                    row[k] = color;
+                    changed |= 1u << k;
+                }
+            }
+        }
+        return changed;
+    }
+};
+
+// Keeps the downsampled copy the bar chart draws and refreshes only the
+// samples that fall into dirty blocks
+class ArraySamples
+{
+public:
+    const std::vector<int>& update(const int* data, int number, const DirtySet& dirty)
+    {
+        if (number != sampled_number)
+        {
+            samples = downsampleArray(data, number);
+            sampled_number = number;
+            step = number <= max_points ? 1 : number / max_points;
+            return samples;
+        }
+        for (int block = 0; block < DirtySet::capacity; block++)
+        {
+            if (!(dirty.bits[block >> 6] >> (block & 63) & 1))
+                continue;
+            long long begin = (long long)block << dirty.shift;
+            if (begin >= number)
+                break;
+            long long end = std::min<long long>(number, (long long)(block + 1) << dirty.shift);
+            // Last block also owns everything past the capacity
+            if (block == DirtySet::capacity - 1)
+                end = number;
+            for (long long j = (begin + step - 1) / step; j * step < end; j++)
+                samples[j] = data[j * step];
+        }
+        return samples;
+    }
+
+private:
+    static const int max_points = 100000; // same as downsampleArray
+
+    std::vector<int> samples;
+    int              sampled_number = -1;
+    int              step = 1;
+};
+
+//------SORTEDNESS METRICS---------------------------------------------------------
+//
+// How far an array is from sorted, measured a few ways:
+//  - inversions:   pairs i < j with a[i] > a[j]
+//  - runs:         maximal ascending stretches, 1 once sorted
+//  - displacement: distance of each element from where it ends up when sorted
+//  - LIS:          length of the longest strictly increasing subsequence
+// Runs and displacement are kept per dirty block and patched from the blocks a
+// sort touched. Inversions and LIS depend on the whole array, so they are
+// recomputed from scratch (inversions on several threads) when asked for.
+
+uint64_t mergeCount(const int* src, int* dst, int lo, int mid, int hi)
+{
+    uint64_t inversions = 0;
+    int i = lo, j = mid, k = lo;
+    while (i < mid && j < hi)
+    {
+        if (src[j] < src[i])
+        {
+            inversions += mid - i;
+            dst[k++] = src[j++];
+        }
+        else
+            dst[k++] = src[i++];
+    }
+    while (i < mid) dst[k++] = src[i++];
+    while (j < hi)  dst[k++] = src[j++];
+    return inversions;
+}
+
+// Bottom-up merge sort of data[lo, hi) that counts the inversions on the way
+uint64_t sortCountInversions(int* data, int* buffer, int lo, int hi)
+{
+    uint64_t inversions = 0;
+    int* src = data;
+    int* dst = buffer;
+    // 64-bit, doubling past 2^30 would overflow an int
+    for (int64_t width = 1; width < hi - lo; width *= 2)
+    {
+        for (int64_t left = lo; left < hi; left += 2 * width)
+        {
+            int mid = (int)std::min<int64_t>(left + width, hi), right = (int)std::min<int64_t>(left + 2 * width, hi);
+            inversions += mergeCount(src, dst, (int)left, mid, right);
+        }
+        std::swap(src, dst);
+    }
+    if (src != data)
+        std::copy(src + lo, src + hi, data + lo);
+    return inversions;
+}
+
+uint64_t countInversions(const int* array, int number, int threads = (int)std::thread::hardware_concurrency())
+{
+    std::vector<int> data(array, array + number), buffer(number);
+    int parts = 1;
+    if (number >= (1 << 16))
+        while (parts * 2 <= std::min(8, threads))
+            parts *= 2;
+
+    // Count inside each part in parallel, then merge pairs of parts level by level.
+    // A level reads the counts of the one below and writes its own to next.
+    std::vector<uint64_t> inversions(parts), next(parts);
+    auto bound = [&](int part, int of) { return (int)((long long)part * number / of); };
+    std::vector<std::thread> workers;
+    for (int p = 0; p < parts; p++)
+        workers.emplace_back([&, p] { inversions[p] = sortCountInversions(data.data(), buffer.data(), bound(p, parts), bound(p + 1, parts)); });
+    for (std::thread& worker : workers)
+        worker.join();
+
+    for (; parts > 1; parts /= 2)
+    {
+        workers.clear();
+        for (int q = 0; q < parts / 2; q++)
+            workers.emplace_back([&, q]
+            {
+                int lo = bound(2 * q, parts), mid = bound(2 * q + 1, parts), hi = bound(2 * q + 2, parts);
+                next[q] = inversions[2 * q] + inversions[2 * q + 1] + mergeCount(data.data(), buffer.data(), lo, mid, hi);
+                std::copy(buffer.begin() + lo, buffer.begin() + hi, data.begin() + lo);
+            });
+        for (std::thread& worker : workers)
+            worker.join();
+        inversions.swap(next);
+    }
+    return inversions[0];
+}
+
+// The split count on 8 parts against one sort of the whole array
+bool parallelInversionsMatch()
+{
+    const int number = 1 << 17;
+    std::vector<int> keys(number), copy(number), buffer(number);
+    std::mt19937 random(number);
+    for (int& key : keys)
+        key = (int)(random() % 1000);
+    copy = keys;
+    return countInversions(keys.data(), number, 8) == sortCountInversions(copy.data(), buffer.data(), 0, number);
+}
+
+int longestIncreasingSubsequence(const int* array, int number)
+{
+    // tails[k] is the smallest tail of any increasing subsequence of length k + 1
+    std::vector<int> tails;
+    for (int i = 0; i < number; i++)
+    {
+        auto it = std::lower_bound(tails.begin(), tails.end(), array[i]);
+        if (it == tails.end())
+            tails.push_back(array[i]);
+        else
+            *it = array[i];
+    }
+    return (int)tails.size();
+}
+
+struct SortednessReport
+{
+    int      number = 0;
+    uint64_t inversions = 0;
+    int      runs = 0;
+    int      max_displacement = 0;
+    double   mean_displacement = 0.0;
+    int      lis = 0;
+};
+
+class SortednessMetrics
+{
+public:
+    // Full pass, needed whenever the array or the block size changes
+    void reset(const int* array, int array_number, int block_shift)
+    {
+        number = array_number;
+        shift = block_shift;
+        sorted.assign(array, array + number);
+        std::sort(sorted.begin(), sorted.end());
+        identity = true;
+        for (int i = 0; i < number && identity; i++)
+            identity = sorted[i] == i;
+
+        blocks = number > 0 ? (int)std::min<long long>(((long long)(number - 1) >> shift) + 1, DirtySet::capacity) : 0;
+        breaks.assign(blocks, 0);
+        displacement_sum.assign(blocks, 0);
+        displacement_max.assign(blocks, 0);
+        for (int b = 0; b < blocks; b++)
+            recount(array, b);
+        summarize();
+        refreshGlobal(array);
+    }
+
+    void update(const int* array, const DirtySet& dirty)
+    {
+        if (dirty.shift != shift)
+        {
+            reset(array, number, dirty.shift);
+            return;
+        }
+        bool previous = false;
+        for (int b = 0; b < blocks; b++)
+        {
+            bool touched = dirty.bits[b >> 6] >> (b & 63) & 1;
+            // The first break of a block compares against the last element of the one before
+            if (touched || previous)
+                recount(array, b);
+            previous = touched;
+        }
+        summarize();
+    }
+
+    // The O(n log n) part
+    void refreshGlobal(const int* array)
+    {
+        report.inversions = countInversions(array, number);
+        report.lis = longestIncreasingSubsequence(array, number);
+    }
+
+    const SortednessReport& get() const { return report; }
+
+private:
+    int                    number = 0;
+    int                    shift = 0;
+    int                    blocks = 0;
+    bool                   identity = true; // sorted array is 0..n-1, like Sortik's own data
+    std::vector<int>       sorted;
+    std::vector<int>       breaks;          // i in block with a[i] < a[i - 1]
+    std::vector<long long> displacement_sum;
+    std::vector<int>       displacement_max;
+    SortednessReport       report;
+
+    int blockEnd(int b) const { return b == blocks - 1 ? number : (b + 1) << shift; }
+
+    int displacement(int index, int value) const
+    {
+        if (identity)
+            return std::abs(index - value);
+        // Equal keys can end up anywhere in their range
+        int first = (int)(std::lower_bound(sorted.begin(), sorted.end(), value) - sorted.begin());
+        int last = (int)(std::upper_bound(sorted.begin(), sorted.end(), value) - sorted.begin());
+        return index < first ? first - index : (index >= last ? index - last + 1 : 0);
+    }
+
+    void recount(const int* array, int b)
+    {
+        int begin = b << shift, end = blockEnd(b);
+        int block_breaks = 0, block_max = 0;
+        long long block_sum = 0;
+        for (int i = begin; i < end; i++)
+        {
+            if (i > 0 && array[i] < array[i - 1])
+                block_breaks++;
+            int d = displacement(i, array[i]);
+            block_sum += d;
+            block_max = std::max(block_max, d);
+        }
+        breaks[b] = block_breaks;
+        displacement_sum[b] = block_sum;
+        displacement_max[b] = block_max;
+    }
+
+    void summarize()
+    {
+        long long total_breaks = 0, total_displacement = 0;
+        int max_displacement = 0;
+        for (int b = 0; b < blocks; b++)
+        {
+            total_breaks += breaks[b];
+            total_displacement += displacement_sum[b];
+            max_displacement = std::max(max_displacement, displacement_max[b]);
+        }
+        report.number = number;
+        report.runs = number > 0 ? (int)total_breaks + 1 : 0;
+        report.max_displacement = max_displacement;
+        report.mean_displacement = number > 0 ? (double)total_displacement / number : 0.0;
+    }
+};
+
+//------PROGRESS SAMPLER-----------------------------------------------------------
+//
+// The frame loop only sees progress when it draws, so its numbers follow VSYNC.
+// The sampler thread instead records every running sort at a fixed rate into a
+// ring the UI reads without locking: the writer publishes `head` after filling
+// a slot, the reader copies and then drops whatever the writer may have lapped.
+
+struct ProgressSample
+{
+    double           time_s;      // since the run started
+    double           operations;
+    float            sortedness;  // share of adjacent pairs in order
+    SortednessReport metrics;
+};
+
+class SampleRing
+{
+public:
+    static const uint64_t capacity = 1 << 14;
+
+    void push(const ProgressSample& sample)
+    {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        samples[h & (capacity - 1)] = sample;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Only safe while nobody pushes
+    void clear() { head.store(0, std::memory_order_relaxed); }
+
+    void snapshot(std::vector<ProgressSample>& out) const
+    {
+        uint64_t end = head.load(std::memory_order_acquire);
+        uint64_t begin = end > capacity ? end - capacity : 0;
+        out.clear();
+        for (uint64_t i = begin; i < end; i++)
+            out.push_back(samples[i & (capacity - 1)]);
+        uint64_t lapped = head.load(std::memory_order_acquire);
+        if (lapped > begin + capacity)
+            out.erase(out.begin(), out.begin() + std::min<uint64_t>(out.size(), lapped - begin - capacity));
+    }
+
+private:
+    ProgressSample        samples[capacity];
+    std::atomic<uint64_t> head{ 0 };
+};
+
+class ProgressSampler
+{
+public:
+    struct Channel
+    {
+        const char*             name;
+        const std::atomic<int>* operations;
+        DirtyBlocks*            dirty;
+        SampleRing              ring;
+        // guarded by the sampler mutex
+        const int*              array = nullptr;
+        int                     number = 0;
+        bool                    active = false;
+        bool                    fresh = false;     // metrics need a full pass
+        bool                    finishing = false; // take the last sample and stop
+        int                     generation = 0;
+        std::chrono::steady_clock::time_point start;
+        // only touched by the sampler thread
+        SortednessMetrics       metrics;
+        std::chrono::steady_clock::time_point next_global;
+    };
+
+    std::atomic<int> rate_hz{ 100 };
+
+    int addChannel(const char* name, const std::atomic<int>* operations, DirtyBlocks* dirty)
+    {
+        channels.emplace_back(new Channel());
+        channels.back()->name = name;
+        channels.back()->operations = operations;
+        channels.back()->dirty = dirty;
+        return (int)channels.size() - 1;
+    }
+
+    void start()
+    {
+        stopping = false;
+        thread = std::thread(&ProgressSampler::run, this);
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (thread.joinable())
+            thread.join();
+    }
+
+    void beginRun(int channel, const int* array, int number)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Channel& c = *channels[channel];
+            c.ring.clear();
+            c.array = array;
+            c.number = number;
+            c.active = true;
+            c.fresh = true;
+            c.finishing = false;
+            c.generation++;
+            c.start = std::chrono::steady_clock::now();
+        }
+        wake.notify_all();
+    }
+
+    // The sampler takes one last sample so the curves end at the final state
+    void endRun(int channel)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Channel& c = *channels[channel];
+        if (c.active)
+            c.finishing = true;
+    }
+
+    const Channel& channel(int index) const { return *channels[index]; }
+    int channelCount() const { return (int)channels.size(); }
+
+private:
+    struct Job
+    {
+        Channel*       channel;
+        int            generation;
+        const int*     array;
+        int            number;
+        bool           fresh;
+        bool           finishing;
+        ProgressSample sample;
+    };
+
+    std::vector<std::unique_ptr<Channel>> channels;
+    std::thread             thread;
+    std::mutex              mutex;
+    std::condition_variable wake;
+    bool                    stopping = false;
+    DirtySet                changes;
+
+    // Runs without the mutex, the metrics can take a while on big arrays
+    void sample(Job& job)
+    {
+        Channel& c = *job.channel;
+        auto now = std::chrono::steady_clock::now();
+        job.sample.time_s = std::chrono::duration<double>(now - c.start).count();
+        job.sample.operations = (double)c.operations->load(std::memory_order_relaxed);
+
+        c.dirty->collect(changes, DirtyConsumer_Metrics);
+        if (job.fresh)
+        {
+            c.metrics.reset(job.array, job.number, changes.shift);
+            c.next_global = std::chrono::steady_clock::now();
+        }
+        else
+        {
+            c.metrics.update(job.array, changes);
+            // Inversions and LIS cost a full O(n log n) pass, keep them under ~10% of the time
+            if (job.finishing || now >= c.next_global)
+            {
+                auto begin = std::chrono::steady_clock::now();
+                c.metrics.refreshGlobal(job.array);
+                auto end = std::chrono::steady_clock::now();
+                c.next_global = end + (end - begin) * 9;
+            }
+        }
+        job.sample.metrics = c.metrics.get();
+        job.sample.sortedness = job.number > 1 ? 1.0f - (float)(job.sample.metrics.runs - 1) / (job.number - 1) : 1.0f;
+    }
+
+    bool anyActive() const
+    {
+        for (const std::unique_ptr<Channel>& c : channels)
+            if (c->active)
+                return true;
+        return false;
+    }
+
+    void run()
+    {
+        auto next_tick = std::chrono::steady_clock::now();
+        std::vector<Job> jobs;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping)
+        {
+            // Sleep for good while nothing runs
+            if (!anyActive())
+            {
+                wake.wait(lock, [&] { return stopping || anyActive(); });
+                next_tick = std::chrono::steady_clock::now();
+                continue;
+            }
+
+            jobs.clear();
+            for (std::unique_ptr<Channel>& c : channels)
+            {
+                if (!c->active)
+                    continue;
+                jobs.push_back({ c.get(), c->generation, c->array, c->number, c->fresh, c->finishing, {} });
+                c->fresh = false;
+            }
+            lock.unlock();
+            for (Job& job : jobs)
+                sample(job);
+            lock.lock();
+            for (Job& job : jobs)
+            {
+                // A new run may have started meanwhile, its ring is already cleared
+                if (job.channel->generation != job.generation)
+                    continue;
+                job.channel->ring.push(job.sample);
+                if (job.finishing)
+                    job.channel->active = false;
+            }
+
+            next_tick += std::chrono::microseconds(1000000 / std::max(1, rate_hz.load()));
+            auto now = std::chrono::steady_clock::now();
+            if (next_tick < now)
+                next_tick = now; // don't try to catch up after a stall
+            wake.wait_until(lock, next_tick, [&] { return stopping; });
+        }
+    }
+};
+
+#ifdef DEVELOPER_OPTIONS
+std::string debug_array(const int* array, const int number)
+{
+    std::string info;
+    for (int i = 0; i < number; i++)
+    {
+        info += std::to_string(array[i]) + " ";
+    }
+    return info;
+}
+#endif
+
+//=================================================================================
+//      BENCHMARK
+//=================================================================================
+//
+// Headless mode runs every engine over a matrix of array sizes and writes one
+// line per trial to a CSV file:
+//
+//   Sortik --headless --sizes 1000,10000 --trials 20 --out results.csv
+//
+// Passing --baseline loads an earlier results file instead, reruns the same
+// matrix and compares each case with a Mann-Whitney U test. The process exits
+// with 1 if any case is slower than the baseline by more than --threshold
+// (fraction of the baseline median) with p < --alpha.
+//
+// Trials are independent, so --jobs N spreads them over N workers, each pinned
+// to its own core and sorting its own buffer (--jobs 0 uses every core). For
+// numbers that aren't disturbed by neighbours, --isolate-core K runs one trial
+// at a time on core K instead.
+//
+// --record PREFIX writes a trace of every trial to PREFIX_<engine>_<n>_<trial>.srt
+//
+// --calibrate measures the auto engine's thresholds again and rewrites
+// sortik_calibration.txt before running anything else.
+//
+// --simd scalar|sse2|avx2|avx512 caps the vector kernels below what the CPU
+// supports, to compare them on the same machine.
+//
+// --input random|nearly picks what the arrays look like: a shuffle (default), or
+// in order apart from about one key in 8 swapped with one up to 16 places ahead.
+//
+// Selection engines (partial, nth, heap, radixsel) run once per k in --k 1,100,...
+// (1000 by default), and their CSV lines carry it in a fifth column.
+//
+// --dataset FILE benchmarks every engine on the int32 keys in FILE instead.
+// --save-dataset FILE writes the input for the first of --sizes (and --input,
+// --seed) to FILE and stops, with a header unless --raw is given.
+//
+// --pages default|thp|hugetlb and --numa default|interleave|touch pick how the
+// key arrays are allocated. Every case reports its dTLB and cache misses (when
+// perf events are allowed) and where the pages of its array landed.
+//
+// Engines that promise stability are checked on records with repeated keys
+// first, and a failed check exits with 2 like a failed sort.
+
+struct SortEngine
+{
+    const char*  name;
+    SortFunction sort;
+    bool       (*stability_check)() = nullptr;     // only set for engines that promise it
+    SelectKind   select = Select_None;            // selection engines only order part of the array
+};
+
+// Bogosort is left out on purpose: it never finishes beyond a dozen elements
+SortEngine bench_engines[] = {
+    { "shell",    shellSort },
+    { "radix",    radixSort },
+    { "lsd",      lsdRadixSortEngine<Scatter_Direct> },
+    { "lsd-wc",   lsdRadixSortEngine<Scatter_Combining> },
+    { "counting", countingSort },
+    { "block",    blockMergeSort },
+    { "vquick",   vectorQuickSortEngine },
+    { "msd",      msdRadixSortEngine },
+    { "merge",    stableMergeSortEngine,  stableMergeIsStable },
+    { "merge-ip", inPlaceMergeSortEngine, inPlaceMergeIsStable },
+    { "tim",      timSortEngine,          timSortIsStable },
+    { "partial",  partialSortEngine,      nullptr, Select_Prefix },
+    { "nth",      nthElementEngine,       nullptr, Select_Nth },
+    { "heap",     heapTopKEngine,         nullptr, Select_Prefix },
+    { "radixsel", radixSelectEngine,      nullptr, Select_Prefix },
+    { "auto",     autoSort },
+};
+
+enum BenchInput
+{
+    BenchInput_Random,
+    BenchInput_Nearly,
+    BenchInput_Count
+};
+
+const char* bench_input_names[BenchInput_Count] = { "random", "nearly" };
+
+struct BenchCase
+{
+    std::string         engine;
+    int                 number;
+    std::vector<double> samples_ms;
+    int                 k = 0;          // selection engines only
+    std::vector<long long> dtlb_misses = {}; // per trial, -1 if not counted
+    std::vector<long long> cache_misses = {};
+    std::string         placement = ""; // pages of the last trial's array
+};
+
+struct BenchOptions
+{
+    std::vector<int> sizes     = { 1000, 10000 };
+    std::vector<int> ks        = { 1000 };     // swept by the selection engines
+    int              trials    = 10;
+    unsigned         seed      = 1;
+    double           threshold = 0.05;
+    double           alpha     = 0.05;
+    std::string      out_path  = "bench_results.csv";
+    std::string      baseline_path;
+    int              jobs      = 1;
+    int              isolated_core = -1; // -1 - not isolated
+    std::string      trace_prefix;       // record a trace per trial if set
+    bool             calibrate = false;
+    int              input     = BenchInput_Random;
+    std::string      external_in;        // --external-sort mode if set
+    std::string      external_out;
+    size_t           memory_mb = 1024;
+    std::string      run_engine = "vquick";
+    std::string      temp_dir  = ".";
+    std::string      dataset_path;       // sort these keys instead of generated ones
+    std::string      save_path;          // write the generated input here and stop
+    bool             raw       = false;  // save without a header
+};
+
+const SortEngine* findEngine(const std::string& name)
+{
+    for (const SortEngine& engine : bench_engines)
+        if (name == engine.name)
+            return &engine;
+    return nullptr;
+}
+
+// Inputs only depend on seed, size and trial, so reruns see the same data
+int* makeBenchInput(const BenchOptions& options, int number, int trial)
+{
+    int* array;
+    if (!options.dataset_path.empty())
+    {
+        // The file may have changed since the cases were sized on it
+        Dataset dataset;
+        if (!dataset.open(options.dataset_path, false) || !dataset.ints() || dataset.header.count < (uint64_t)number)
+            return nullptr;
+        array = allocKeys(number);
+        memcpy(array, dataset.ints(), (size_t)number * sizeof(int));
+        return array;
+    }
+    updateIntArray(number, array);
+    std::mt19937 gen(options.seed + 7919u * (unsigned)trial + (unsigned)number);
+    if (options.input == BenchInput_Nearly)
+        nearlySortIntArray(number, array, gen);
+    else
+        shuffleIntArray(number, array, gen);
+    return array;
+}
+
+struct TrialMemory
+{
+    long long    dtlb_misses = -1;
+    long long    cache_misses = -1;
+    KeyPlacement placement;
+};
+
+// Runs one engine on a fresh input and returns the wall time in ms. A dataset is
+// sorted where it's mapped, so its pages are copied as the engine first writes them.
+double runTrial(const SortEngine& engine, int number, int k, int trial, const BenchOptions& options, bool& sorted, const std::string& trace_path = "",
+                TrialMemory* memory = nullptr)
+{
+    Dataset dataset;
+    int* array = nullptr;
+    if (options.dataset_path.empty())
+        array = makeBenchInput(options, number, trial);
+    else if (dataset.open(options.dataset_path, true))
+        array = dataset.ints();
+    if (!array)
+    {
+        sorted = false;
+        return 0.0;
+    }
+
+    select_k = k;
+    uint64_t fingerprint = keyFingerprint(array, number);
+    std::atomic<int> oper_count(0);
+    std::atomic<double> sort_time_ms(0.0);
+    MissCounter dtlb(Miss_Dtlb), cache(Miss_Cache);
+    if (memory)
+    {
+        dtlb.start();
+        cache.start();
+    }
+    auto start_time = std::chrono::high_resolution_clock::now();
+    if (trace_path.empty())
+        engine.sort(array, number, oper_count, sort_time_ms);
+    else
+        trackedSort(engine.sort, nullptr, trace_path, array, number, oper_count, sort_time_ms);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    if (memory)
+    {
+        memory->dtlb_misses = dtlb.stop();
+        memory->cache_misses = cache.stop();
+        memory->placement = keyPlacement(array, (size_t)number);
+    }
+
+    sorted = engine.select == Select_None ? verifyArrayIsSorted(array, number) : verifySelection(array, number, k, engine.select);
+    sorted = sorted && keyFingerprint(array, number) == fingerprint;
+    if (!dataset.isOpen())
+        freeKeys(array);
+    return std::chrono::duration<double, std::milli>(end_time - start_time).count();
+}
+
+bool pinThreadToCore(int core)
+{
+#ifdef _WIN32
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)core;
+    return false;
+#endif
+}
+
+struct BenchTrial
+{
+    size_t case_index;
+    int    trial;
+};
+
+// Runs every trial of every case on a pool of pinned workers.
+// samples_ms must already be sized to the trial count of each case.
+bool runBenchBatch(std::vector<BenchCase>& cases, const BenchOptions& options)
+{
+    std::vector<BenchTrial> queue;
+    std::vector<const SortEngine*> engines;
+    for (size_t c = 0; c < cases.size(); c++)
+    {
+        engines.push_back(findEngine(cases[c].engine));
+        if (!engines.back())
+        {
+            fprintf(stderr, "Error: unknown engine '%s'\n", cases[c].engine.c_str());
+            return false;
+        }
+        for (int t = 0; t < (int)cases[c].samples_ms.size(); t++)
+            queue.push_back({ c, t });
+    }
+
+    int cores = std::max(1, (int)std::thread::hardware_concurrency());
+    int workers = options.jobs > 0 ? options.jobs : cores;
+    if (options.isolated_core >= 0)
+        workers = 1;
+    workers = std::min(workers, std::max(1, (int)queue.size()));
+
+    std::atomic<size_t> next_trial(0);
+    std::atomic<bool> failed(false);
+    auto worker = [&](int index)
+    {
+        bench_worker = true;
+        bool pinned = options.isolated_core >= 0 || workers > 1;
+        if (pinned)
+        {
+            int core = options.isolated_core >= 0 ? options.isolated_core : index % cores;
+            if (!pinThreadToCore(core))
+                fprintf(stderr, "Warning: can't pin worker %d to core %d\n", index, core);
+        }
+        for (size_t i = next_trial++; i < queue.size() && !failed; i = next_trial++)
+        {
+            const BenchTrial& job = queue[i];
+            BenchCase& bench_case = cases[job.case_index];
+            bool sorted;
+            std::string trace_path;
+            if (!options.trace_prefix.empty())
+                trace_path = options.trace_prefix + "_" + bench_case.engine + "_" + std::to_string(bench_case.number)
+                           + (bench_case.k ? "_k" + std::to_string(bench_case.k) : std::string()) + "_" + std::to_string(job.trial) + ".srt";
+            TrialMemory memory;
+            bench_case.samples_ms[job.trial] = runTrial(*engines[job.case_index], bench_case.number, bench_case.k, job.trial, options, sorted, trace_path, &memory);
+            bench_case.dtlb_misses[job.trial] = memory.dtlb_misses;
+            bench_case.cache_misses[job.trial] = memory.cache_misses;
+            if (job.trial + 1 == (int)bench_case.samples_ms.size())
+                bench_case.placement = memory.placement.describe();
+            if (!sorted)
+            {
+                fprintf(stderr, "Error: %s failed to sort %d numbers\n", bench_case.engine.c_str(), bench_case.number);
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int w = 1; w < workers; w++)
+        pool.emplace_back(worker, w);
+    worker(0);
+    for (std::thread& thread : pool)
+        thread.join();
+    bench_worker = false;
+
+    return !failed;
+}
+
+bool saveBenchResults(const std::string& path, const std::vector<BenchCase>& cases)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+    fprintf(file, "engine,number,trial,time_ms,k\n");
+    for (const BenchCase& bench_case : cases)
+        for (size_t t = 0; t < bench_case.samples_ms.size(); t++)
+            fprintf(file, "%s,%d,%d,%.6f,%d\n", bench_case.engine.c_str(), bench_case.number, (int)t, bench_case.samples_ms[t], bench_case.k);
+    fclose(file);
+    return true;
+}
+
+bool loadBenchResults(const std::string& path, std::vector<BenchCase>& cases)
+{
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file)
+        return false;
+
+    char line[256];
+    while (fgets(line, sizeof(line), file))
+    {
+        char engine[64];
+        int number, trial, k = 0;
+        double time_ms;
+        if (sscanf(line, "%63[^,],%d,%d,%lf,%d", engine, &number, &trial, &time_ms, &k) < 4)
+            continue; // header or garbage, files from before k have 4 columns
+
+        BenchCase* found = nullptr;
+        for (BenchCase& bench_case : cases)
+            if (bench_case.engine == engine && bench_case.number == number && bench_case.k == k)
+                found = &bench_case;
+        if (!found)
+        {
+            cases.push_back({ engine, number, {}, k });
+            found = &cases.back();
+        }
+        found->samples_ms.push_back(time_ms);
+    }
+    fclose(file);
+    return true;
+}
+
+// Selection cases are told apart by their k
+std::string kLabel(const BenchCase& bench_case)
+{
+    return bench_case.k ? " k=" + std::to_string(bench_case.k) : std::string();
+}
+
+double median(std::vector<double> samples)
+{
+    if (samples.empty())
+        return 0.0;
+    std::sort(samples.begin(), samples.end());
+    size_t mid = samples.size() / 2;
+    return samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2.0;
+}
+
+// Two-sided Mann-Whitney U test, normal approximation with tie correction.
+// Good enough from ~8 samples per side, which is what the matrix runs anyway.
+double mannWhitneyP(const std::vector<double>& a, const std::vector<double>& b)
+{
+    const double n1 = (double)a.size(), n2 = (double)b.size(), n = n1 + n2;
+    if (n1 < 1 || n2 < 1)
+        return 1.0;
+
+    std::vector<std::pair<double, int>> pooled;
+    for (double x : a) pooled.push_back({ x, 0 });
+    for (double x : b) pooled.push_back({ x, 1 });
+    std::sort(pooled.begin(), pooled.end());
+
+    double rank_sum_a = 0.0, tie_term = 0.0;
+    for (size_t i = 0; i < pooled.size();)
+    {
+        size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first)
+            j++;
+        double ties = (double)(j - i);
+        double rank = (i + 1 + j) / 2.0; // average of ranks i+1..j
+        for (size_t k = i; k < j; k++)
+            if (pooled[k].second == 0)
+                rank_sum_a += rank;
+        tie_term += ties * ties * ties - ties;
+        i = j;
+    }
+
+    double u = rank_sum_a - n1 * (n1 + 1) / 2.0;
+    double mean = n1 * n2 / 2.0;
+    double variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)));
+    if (variance <= 0.0)
+        return 1.0;
+    double z = (std::fabs(u - mean) - 0.5) / std::sqrt(variance);
+    if (z < 0.0)
+        z = 0.0;
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+std::vector<int> parseSizes(const char* list)
+{
+    std::vector<int> sizes;
+    for (const char* p = list; *p;)
+    {
+        char* end;
+        long value = strtol(p, &end, 10);
+        if (end == p)
+            break;
+        if (value > 0)
+            sizes.push_back((int)value);
+        p = *end == ',' ? end + 1 : end;
+    }
+    return sizes;
+}
+
+// Returns true if argv asked for headless mode and fills options
+bool parseBenchArgs(int argc, char** argv, BenchOptions& options)
+{
+    bool headless = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--headless")
+            headless = true;
+        else if (arg == "--sizes" && has_value)
+            options.sizes = parseSizes(argv[++i]);
+        else if (arg == "--k" && has_value)
+            options.ks = parseSizes(argv[++i]);
+        else if (arg == "--trials" && has_value)
+            options.trials = std::max(1, atoi(argv[++i]));
+        else if (arg == "--seed" && has_value)
+            options.seed = (unsigned)strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--threshold" && has_value)
+            options.threshold = atof(argv[++i]);
+        else if (arg == "--alpha" && has_value)
+            options.alpha = atof(argv[++i]);
+        else if (arg == "--out" && has_value)
+            options.out_path = argv[++i];
+        else if (arg == "--jobs" && has_value)
+            options.jobs = std::max(0, atoi(argv[++i]));
+        else if (arg == "--isolate-core" && has_value)
+            options.isolated_core = std::max(0, atoi(argv[++i]));
+        else if (arg == "--record" && has_value)
+            options.trace_prefix = argv[++i];
+        else if (arg == "--simd" && has_value)
+        {
+            std::string level = argv[++i];
+            int found = -1;
+            for (int l = 0; l <= SimdLevel_AVX512; l++)
+                if (level == simd_level_names[l])
+                    found = l;
+            if (found < 0)
+                fprintf(stderr, "Unknown SIMD level: %s\n", level.c_str());
+            else if (found > simd_supported)
+                fprintf(stderr, "This CPU only supports up to %s\n", simd_level_names[simd_supported]);
+            else
+                simd_level = (SimdLevel)found;
+        }
+        else if (arg == "--input" && has_value)
+        {
+            std::string input = argv[++i];
+            int found = -1;
+            for (int p = 0; p < BenchInput_Count; p++)
+                if (input == bench_input_names[p])
+                    found = p;
+            if (found < 0)
+                fprintf(stderr, "Unknown input: %s\n", input.c_str());
+            else
+                options.input = found;
+        }
+        else if (arg == "--external-sort" && i + 2 < argc)
+        {
+            options.external_in = argv[++i];
+            options.external_out = argv[++i];
+            headless = true;
+        }
+        else if (arg == "--memory" && has_value)
+            options.memory_mb = (size_t)std::max(1LL, atoll(argv[++i]));
+        else if (arg == "--engine" && has_value)
+            options.run_engine = argv[++i];
+        else if (arg == "--temp" && has_value)
+            options.temp_dir = argv[++i];
+        else if (arg == "--dataset" && has_value)
+        {
+            options.dataset_path = argv[++i];
+            headless = true;
+        }
+        else if (arg == "--save-dataset" && has_value)
+        {
+            options.save_path = argv[++i];
+            headless = true;
+        }
+        else if (arg == "--raw")
+            options.raw = true;
+        else if ((arg == "--pages" || arg == "--numa") && has_value)
+        {
+            bool pages = arg == "--pages";
+            std::string policy = argv[++i];
+            int found = -1;
+            for (int p = 0; p < (pages ? (int)Pages_Count : (int)Numa_Count); p++)
+                if (policy == (pages ? page_policy_names[p] : numa_policy_names[p]))
+                    found = p;
+            if (found < 0)
+                fprintf(stderr, "Unknown %s policy: %s\n", pages ? "page" : "NUMA", policy.c_str());
+            else if (pages)
+                alloc_policy.pages = found;
+            else
+                alloc_policy.numa = found;
+        }
+        else if (arg == "--calibrate")
+        {
+            options.calibrate = true;
+            headless = true;
+        }
+        else if (arg == "--baseline" && has_value)
+        {
+            options.baseline_path = argv[++i];
+            headless = true;
+        }
+        else
+            fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+    }
+    return headless;
+}
+
+// Exit codes: 0 - fine, 1 - regression found, 2 - bad input or failed sort
+int runHeadlessBenchmark(const BenchOptions& options)
+{
+    std::vector<BenchCase> baseline;
+    std::vector<BenchCase> cases;
+
+    if (!options.baseline_path.empty())
+    {
+        if (!loadBenchResults(options.baseline_path, baseline) || baseline.empty())
+        {
+            fprintf(stderr, "Error: can't read baseline %s\n", options.baseline_path.c_str());
+            return 2;
+        }
+        for (const BenchCase& base : baseline)
+            cases.push_back({ base.engine, base.number, {}, base.k });
+    }
+    else
+    {
+        for (const SortEngine& engine : bench_engines)
+            for (int number : options.sizes)
+            {
+                if (engine.select == Select_None)
+                    cases.push_back({ engine.name, number, {} });
+                else
+                    for (int k : options.ks)
+                        cases.push_back({ engine.name, number, {}, k });
+            }
+    }
+
+    if (!options.save_path.empty())
+    {
+        int number = options.sizes.empty() ? 0 : options.sizes[0];
+        int* array = makeBenchInput(options, number, 0);
+        if (!array)
+        {
+            fprintf(stderr, "Error: can't read %d keys from %s\n", number, options.dataset_path.c_str());
+            return 2;
+        }
+        bool saved = saveDataset(options.save_path, array, (uint64_t)number, options.seed, options.raw);
+        freeKeys(array);
+        if (!saved)
+        {
+            fprintf(stderr, "Error: can't write %s\n", options.save_path.c_str());
+            return 2;
+        }
+        printf("Saved %d %s keys to %s\n", number, bench_input_names[options.input], options.save_path.c_str());
+        return 0;
+    }
+
+    if (!options.dataset_path.empty())
+    {
+        Dataset dataset;
+        if (!dataset.open(options.dataset_path, false))
+        {
+            fprintf(stderr, "Error: can't read dataset %s\n", options.dataset_path.c_str());
+            return 2;
+        }
+        const DatasetHeader& header = dataset.header;
+        if (!dataset.ints() || header.count > INT_MAX)
+        {
+            fprintf(stderr, "Error: engines sort up to %d int32 keys, %s has %llu %s keys\n", INT_MAX, options.dataset_path.c_str(),
+                    (unsigned long long)header.count, dataset_type_names[header.type]);
+            return 2;
+        }
+        printf("Dataset: %s, %llu %s keys, seed %llu\n", options.dataset_path.c_str(), (unsigned long long)header.count,
+               dataset_type_names[header.type], (unsigned long long)header.seed);
+        // Every case sorts the whole dataset
+        for (BenchCase& bench_case : cases)
+        {
+            if (!baseline.empty() && bench_case.number != (int)header.count)
+            {
+                fprintf(stderr, "Error: baseline has n=%d, the dataset has %llu keys\n", bench_case.number, (unsigned long long)header.count);
+                return 2;
+            }
+            bench_case.number = (int)header.count;
+        }
+        // Sizes no longer tell cases apart, keep the first of each engine and k
+        if (baseline.empty())
+        {
+            std::set<std::pair<std::string, int>> seen;
+            cases.erase(std::remove_if(cases.begin(), cases.end(), [&](const BenchCase& bench_case) { return !seen.insert({ bench_case.engine, bench_case.k }).second; }),
+                        cases.end());
+        }
+    }
+
+    for (size_t c = 0; c < cases.size(); c++)
+    {
+        cases[c].samples_ms.resize(baseline.empty() ? options.trials : baseline[c].samples_ms.size());
+        cases[c].dtlb_misses.resize(cases[c].samples_ms.size(), -1);
+        cases[c].cache_misses.resize(cases[c].samples_ms.size(), -1);
+    }
+
+    printf("Vector kernels: %s\n", simd_level_names[simd_level]);
+    uint64_t nodes = onlineNodes();
+    int node_count = 0;
+    for (; nodes; nodes &= nodes - 1)
+        node_count++;
+    printf("Pages: %s, NUMA: %s over %d node(s)\n", page_policy_names[alloc_policy.pages], numa_policy_names[alloc_policy.numa], node_count);
+    if (options.dataset_path.empty())
+        printf("Input: %s\n", bench_input_names[options.input]);
+
+    // Calibrating inside the first auto trial would show up as its time
+    const AutoTuning& tuning = autoTuning(options.calibrate);
+    if (options.calibrate)
+        printf("Calibrated: insertion up to n=%d or %.3f%% descents, radix from n=%d, counting up to %dn keys\n",
+               tuning.small_number, tuning.presorted_ratio * 100.0, tuning.radix_number, tuning.counting_range);
+
+    if (!parallelInversionsMatch())
+    {
+        fprintf(stderr, "Error: parallel inversion count disagrees with the serial one\n");
+        return 2;
+    }
+
+    for (const SortEngine& engine : bench_engines)
+    {
+        if (!engine.stability_check)
+            continue;
+        bool benched = std::any_of(cases.begin(), cases.end(), [&](const BenchCase& bench_case) { return bench_case.engine == engine.name; });
+        if (!benched)
+            continue;
+        if (!engine.stability_check())
+        {
+            fprintf(stderr, "Error: %s reordered equal keys\n", engine.name);
+            return 2;
+        }
+        printf("Stable: %s\n", engine.name);
+    }
+
+    if (!runBenchBatch(cases, options))
+        return 2;
+
+    for (const BenchCase& bench_case : cases)
+    {
+        const std::vector<double>& samples = bench_case.samples_ms;
+        double mean = 0.0, deviation = 0.0;
+        for (double x : samples) mean += x;
+        mean /= samples.size();
+        for (double x : samples) deviation += (x - mean) * (x - mean);
+        deviation = samples.size() > 1 ? std::sqrt(deviation / (samples.size() - 1)) : 0.0;
+        printf("%-8s n=%-10d%s median %10.3f ms, mean %10.3f +- %.3f ms, min %10.3f ms\n", bench_case.engine.c_str(), bench_case.number, kLabel(bench_case).c_str(),
+               median(samples), mean, deviation, *std::min_element(samples.begin(), samples.end()));
+    }
+
+    // Measured around the same trials, kept out of the CSV so old baselines still load
+    auto missText = [](const char* name, const std::vector<long long>& counts, int number)
+    {
+        std::vector<double> misses;
+        for (long long count : counts)
+            if (count >= 0)
+                misses.push_back((double)count);
+        char text[96];
+        if (misses.empty())
+            snprintf(text, sizeof(text), "%s misses n/a", name);
+        else
+            snprintf(text, sizeof(text), "%s misses %.0f (%.4f per key)", name, median(misses), median(misses) / std::max(1, number));
+        return std::string(text);
+    };
+    for (const BenchCase& bench_case : cases)
+    {
+        std::string misses = missText("dTLB", bench_case.dtlb_misses, bench_case.number) + ", "
+                        + missText("cache", bench_case.cache_misses, bench_case.number);
+        printf("%-8s n=%-10d%s %s, %s\n", bench_case.engine.c_str(), bench_case.number, kLabel(bench_case).c_str(), misses.c_str(), bench_case.placement.c_str());
+    }
+
+    // Outside the timed trials: how many runs tim found and how much galloping saved
+    for (const BenchCase& bench_case : cases)
+    {
+        if (findEngine(bench_case.engine)->sort != timSortEngine)
+            continue;
+        int* array = makeBenchInput(options, bench_case.number, 0);
+        if (!array)
+            continue;
+        TimMetrics metrics;
+        timSort(array, (int64_t)bench_case.number, std::less<int>(), nullptr, &metrics);
+        freeKeys(array);
+        printf("%-8s n=%-10d runs %lld (mean length %.1f), galloping %lld times, %lld hits moving %lld keys\n", bench_case.engine.c_str(), bench_case.number,
+               metrics.runs, (double)bench_case.number / std::max(1LL, metrics.runs), metrics.galloping, metrics.gallop_hits, metrics.galloped_keys);
+    }
+
+    if (!saveBenchResults(options.out_path, cases))
+    {
+        fprintf(stderr, "Error: can't write %s\n", options.out_path.c_str());
+        return 2;
+    }
+    printf("Results saved to %s\n", options.out_path.c_str());
+
+    if (baseline.empty())
+        return 0;
+
+    int regressions = 0;
+    printf("\n%-8s %-10s %12s %12s %9s %8s\n", "engine", "number", "base ms", "now ms", "change", "p");
+    for (size_t c = 0; c < cases.size(); c++)
+    {
+        double base_ms = median(baseline[c].samples_ms);
+        double now_ms  = median(cases[c].samples_ms);
+        double change  = base_ms > 0.0 ? now_ms / base_ms - 1.0 : 0.0;
+        double p       = mannWhitneyP(baseline[c].samples_ms, cases[c].samples_ms);
+        bool significant = p < options.alpha;
+        bool regressed   = significant && change > options.threshold;
+        if (regressed)
+            regressions++;
+        printf("%-8s %-10d%s %12.3f %12.3f %+8.1f%% %8.4f %s\n", cases[c].engine.c_str(), cases[c].number, kLabel(cases[c]).c_str(),
+               base_ms, now_ms, change * 100.0, p, regressed ? "REGRESSION" : (significant && change < 0.0 ? "faster" : ""));
+    }
+    printf("\n%d regression(s) beyond %.1f%%\n", regressions, options.threshold * 100.0);
+    return regressions ? 1 : 0;
+}
+
+//=================================================================================
+//      EXTERNAL SORT
+//=================================================================================
+//
+// Sorts a file of int32 keys that doesn't fit in memory, a dataset or raw keys:
+//
+//   Sortik --external-sort keys.bin sorted.bin --memory 48000 --temp /scratch
+//
+// The input is read in chunks sized to the --memory budget (MB, 1024 by default),
+// each chunk is sorted by an in-memory engine (--engine, vquick by default) and
+// spilled to --temp as a sorted run. A loser tree then merges up to
+// external_fan_in runs at a time, over several passes if there are more.
+// Reads and writes are double buffered on their own threads, so the disk keeps
+// going while a chunk is sorted or a block merged. The budget covers those
+// buffers only: engines that need scratch (radix, merge) want as much again.
+
+const int external_fan_in = 256;
+const size_t external_min_block = 1 << 16;   // keys per merge buffer, below this the disk seeks between runs
+
+struct ExternalStats
+{
+    long long keys = 0;
+    int       runs = 0;
+    int       passes = 0;
+    double    sort_ms = 0.0;                  // inside the engine
+    double    wait_ms = 0.0;                  // blocked on the disk, what the overlap didn't hide
+};
+
+double waitFor(std::future<size_t>& pending, size_t& result)
+{
+    auto start_time = std::chrono::high_resolution_clock::now();
+    result = pending.get();
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+}
+
+// Reads a file front to back, the next block loading while the caller works on this one
+class BlockReader
+{
+public:
+    BlockReader() = default;
+    BlockReader(const BlockReader&) = delete;
+    BlockReader& operator=(const BlockReader&) = delete;
+    ~BlockReader() { close(); }
+
+    bool open(const std::string& path, size_t block_keys)
+    {
+        file = fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+        // Left uninitialized, a 64 GB budget shouldn't be paged in just to be zeroed
+        for (std::unique_ptr<int[]>& buffer : buffers)
+            buffer.reset(new int[std::max<size_t>(block_keys, 1)]);
+        size = block_keys;
+        current = 0;
+        startRead();
+        return true;
+    }
+
+    // Next block or nullptr at the end, valid until the following call
+    const int* next(size_t& count, double& wait_ms)
+    {
+        wait_ms += waitFor(pending, count);
+        if (count == 0)
+            return nullptr;
+        const int* block = buffers[current].get();
+        current ^= 1;
+        startRead();
+        return block;
+    }
+
+    void close()
+    {
+        if (pending.valid())
+            pending.wait();
+        if (file)
+            fclose(file);
+        file = nullptr;
+    }
+
+private:
+    void startRead()
+    {
+        int* target = buffers[current].get();
+        size_t keys = size;
+        FILE* source = file;
+        pending = std::async(std::launch::async, [=] { return fread(target, sizeof(int), keys, source); });
+    }
+
+    FILE*                  file = nullptr;
+    std::unique_ptr<int[]> buffers[2];
+    size_t                 size = 0;
+    int                    current = 0;
+    std::future<size_t>    pending;
+};
+
+// Collects keys into one buffer while the other is being written
+class BlockWriter
+{
+public:
+    BlockWriter() = default;
+    BlockWriter(const BlockWriter&) = delete;
+    BlockWriter& operator=(const BlockWriter&) = delete;
+    ~BlockWriter() { close(); }
+
+    bool open(const std::string& path, size_t block_keys)
+    {
+        file = fopen(path.c_str(), "wb");
+        if (!file)
+            return false;
+        for (std::unique_ptr<int[]>& buffer : buffers)
+            buffer.reset(block_keys ? new int[block_keys] : nullptr);
+        size = block_keys;
+        current = 0;
+        filled = 0;
+        written = true;
+        return true;
+    }
+
+    void push(int key)
+    {
+        buffers[current][filled++] = key;
+        if (filled == size)
+            flush();
+    }
+
+    // Writes a whole block the caller owns, it must stay put until the next call
+    void write(const int* block, size_t count, double& wait_ms)
+    {
+        finish(wait_ms);
+        FILE* target = file;
+        pending = std::async(std::launch::async, [=] { return fwrite(block, sizeof(int), count, target) == count ? (size_t)1 : (size_t)0; });
+    }
+
+    // False if any write came up short
+    bool close(double* wait_ms = nullptr)
+    {
+        if (!file)
+            return written;
+        double waited = 0.0;
+        flush(&waited);
+        finish(waited);
+        written &= fclose(file) == 0;
+        file = nullptr;
+        if (wait_ms)
+            *wait_ms += waited;
+        return written;
+    }
+
+    double wait_ms = 0.0;
+
+private:
+    void finish(double& waited)
+    {
+        if (!pending.valid())
+            return;
+        size_t ok;
+        waited += waitFor(pending, ok);
+        written &= ok != 0;
+    }
+
+    void flush(double* waited = nullptr)
+    {
+        if (filled == 0)
+            return;
+        write(buffers[current].get(), filled, waited ? *waited : wait_ms);
+        current ^= 1;
+        filled = 0;
+    }
+
+    FILE*                  file = nullptr;
+    std::unique_ptr<int[]> buffers[2];
+    size_t                 size = 0;
+    int                    current = 0;
+    size_t                 filled = 0;
+    bool                   written = true;
+    std::future<size_t>    pending;
+};
+
+// Tournament over k sources where each inner node keeps the loser of its match,
+// so replacing the winner's key replays one leaf-to-root path: log2(k) compares
+// against a stored loser, with no sibling lookups like a heap needs. Entries are
+// key and source packed into one int64, which orders by key and then by source,
+// so each match is a single compare.
+class LoserTree
+{
+public:
+    void reset(int sources)
+    {
+        count = sources;
+        leaves.assign(sources, finished);
+        tree.assign(std::max(sources, 1), finished);
+    }
+
+    void set(int source, int key) { leaves[source] = entry(key, source); }
+
+    void build()
+    {
+        std::vector<int64_t> winners(count, finished);
+        for (int node = count - 1; node >= 1; node--)
+        {
+            int64_t a = 2 * node >= count ? leaves[2 * node - count] : winners[2 * node];
+            int64_t b = 2 * node + 1 >= count ? leaves[2 * node + 1 - count] : winners[2 * node + 1];
+            winners[node] = std::min(a, b);
+            tree[node] = std::max(a, b);
+        }
+        tree[0] = count > 1 ? winners[1] : count == 1 ? leaves[0] : finished;
+    }
+
+    bool empty() const { return tree[0] == finished; }
+    int winner() const { return (int)(uint32_t)tree[0]; }
+    int key() const { return (int)(tree[0] >> 32); }
+
+    void replace(int source, int key) { replay(source, entry(key, source)); }
+    void finish(int source) { replay(source, finished); }
+
+private:
+    static constexpr int64_t finished = INT64_MAX;    // loses to every key
+
+    static int64_t entry(int key, int source) { return (int64_t)key * ((int64_t)1 << 32) | (uint32_t)source; }
+
+    void replay(int source, int64_t winner)
+    {
+        // Selects rather than branches, random keys would mispredict half the matches
+        for (int node = (source + count) / 2; node > 0; node /= 2)
+        {
+            int64_t stored = tree[node];
+            bool stored_wins = stored < winner;
+            tree[node] = stored_wins ? winner : stored;
+            winner = stored_wins ? stored : winner;
+        }
+        tree[0] = winner;
+    }
+
+    int                  count = 0;
+    std::vector<int64_t> leaves;   // only used to build
+    std::vector<int64_t> tree;     // [0] is the overall winner
+};
+
+bool mergeRunFiles(const std::vector<std::string>& inputs, const std::string& output, size_t block_keys, ExternalStats& stats)
+{
+    int sources = (int)inputs.size();
+    std::vector<std::unique_ptr<BlockReader>> readers(sources);
+    std::vector<const int*> blocks(sources);
+    std::vector<size_t> sizes(sources), positions(sources);
+    LoserTree tree;
+    tree.reset(sources);
+    for (int s = 0; s < sources; s++)
+    {
+        readers[s].reset(new BlockReader());
+        if (!readers[s]->open(inputs[s], block_keys))
+        {
+            fprintf(stderr, "Error: can't read run %s\n", inputs[s].c_str());
+            return false;
+        }
+        blocks[s] = readers[s]->next(sizes[s], stats.wait_ms);
+        positions[s] = 0;
+        if (blocks[s])
+            tree.set(s, blocks[s][0]);
+    }
+    tree.build();
+
+    BlockWriter writer;
+    if (!writer.open(output, block_keys))
+    {
+        fprintf(stderr, "Error: can't write %s\n", output.c_str());
+        return false;
+    }
+    while (!tree.empty())
+    {
+        int s = tree.winner();
+        writer.push(tree.key());
+        if (++positions[s] == sizes[s])
+        {
+            blocks[s] = readers[s]->next(sizes[s], stats.wait_ms);
+            positions[s] = 0;
+        }
+        if (blocks[s])
+            tree.replace(s, blocks[s][positions[s]]);
+        else
+            tree.finish(s);
+    }
+    stats.wait_ms += writer.wait_ms;
+    if (!writer.close(&stats.wait_ms))
+    {
+        fprintf(stderr, "Error: short write to %s\n", output.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Reads the input a chunk at a time, sorts each and spills it as a run. Three chunk
+// buffers rotate: one loading, one being sorted, one being written out.
+bool formRuns(const BenchOptions& options, const SortEngine& engine, size_t chunk_keys, const std::string& run_prefix,
+              std::vector<std::string>& runs, ExternalStats& stats)
+{
+    FILE* input = fopen(options.external_in.c_str(), "rb");
+    if (!input)
+    {
+        fprintf(stderr, "Error: can't read %s\n", options.external_in.c_str());
+        return false;
+    }
+    // A dataset header is skipped, without one it's all keys
+    DatasetHeader header;
+    bool has_header = fread(&header, sizeof(header), 1, input) == 1 && memcmp(header.magic, "SRTKDAT", 8) == 0;
+    if (has_header && header.type != DatasetType_Int32)
+    {
+        fprintf(stderr, "Error: %s holds %s keys, only int32 can be sorted\n", options.external_in.c_str(), dataset_type_names[header.type % DatasetType_Count]);
+        fclose(input);
+        return false;
+    }
+    if (!has_header)
+        rewind(input);
+    std::unique_ptr<int[]> chunks[3];
+    for (std::unique_ptr<int[]>& chunk : chunks)
+        chunk.reset(new int[std::max<size_t>(chunk_keys, 1)]);
+    auto startRead = [&](int index)
+    {
+        int* target = chunks[index].get();
+        return std::async(std::launch::async, [=] { return fread(target, sizeof(int), chunk_keys, input); });
+    };
+
+    bool ok = true, unsorted = false;
+    std::unique_ptr<BlockWriter> writers[3];
+    std::future<size_t> reading = startRead(0);
+    for (int k = 0; ok; k++)
+    {
+        size_t count;
+        stats.wait_ms += waitFor(reading, count);
+        if (count == 0)
+            break;
+        int* chunk = chunks[k % 3].get();
+        // Its last user was the run written two chunks ago
+        if (writers[(k + 1) % 3])
+        {
+            ok &= writers[(k + 1) % 3]->close(&stats.wait_ms);
+            writers[(k + 1) % 3].reset();
+        }
+        reading = startRead((k + 1) % 3);
+
+        std::atomic<int> oper_count(0);
+        std::atomic<double> sort_time_ms(0.0);
+        auto start_time = std::chrono::high_resolution_clock::now();
+        engine.sort(chunk, (int)count, oper_count, sort_time_ms);
+        stats.sort_ms += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+        stats.keys += (long long)count;
+        if (!std::is_sorted(chunk, chunk + count))
+        {
+            fprintf(stderr, "Error: %s left run %zu unsorted\n", engine.name, runs.size());
+            unsorted = true;
+            ok = false;
+            break;
+        }
+
+        std::string path = run_prefix + std::to_string(runs.size()) + ".run";
+        writers[k % 3].reset(new BlockWriter());
+        if (!writers[k % 3]->open(path, 0))
+        {
+            fprintf(stderr, "Error: can't write run %s\n", path.c_str());
+            ok = false;
+            break;
+        }
+        runs.push_back(path);
+        writers[k % 3]->write(chunk, count, stats.wait_ms);
+    }
+    if (reading.valid())
+        reading.wait();
+    for (std::unique_ptr<BlockWriter>& writer : writers)
+        if (writer)
+            ok &= writer->close(&stats.wait_ms);
+    fclose(input);
+    if (!ok && !unsorted)
+        fprintf(stderr, "Error: failed writing runs to %s\n", options.temp_dir.c_str());
+    return ok;
+}
+
+int runExternalSort(const BenchOptions& options)
+{
+    const SortEngine* engine = findEngine(options.run_engine);
+    if (!engine)
+    {
+        fprintf(stderr, "Error: unknown engine '%s'\n", options.run_engine.c_str());
+        return 2;
+    }
+    // Runs have to come out fully sorted, over the whole int32 range
+    if (engine->select != Select_None)
+    {
+        fprintf(stderr, "Error: %s only selects, runs need a sorting engine\n", engine->name);
+        return 2;
+    }
+    bench_worker = true;    // nothing on screen to keep in sync
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    size_t budget_keys = std::max<size_t>(options.memory_mb, 1) * (1 << 20) / sizeof(int);
+    size_t chunk_keys = std::min<size_t>(budget_keys / 3, INT_MAX);
+    std::string run_prefix = options.temp_dir + "/sortik_" + std::to_string(rnd()) + "_";
+
+    ExternalStats stats;
+    std::vector<std::string> runs;
+    bool ok = formRuns(options, *engine, chunk_keys, run_prefix, runs, stats);
+    stats.runs = (int)runs.size();
+    double runs_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+    // Each source needs two blocks and so does the output
+    int fan_in = (int)std::max<size_t>(2, std::min<size_t>(external_fan_in, budget_keys / (2 * external_min_block) - 1));
+    for (int pass = 0; ok && (int)runs.size() > fan_in; pass++)
+    {
+        std::vector<std::string> merged;
+        size_t block_keys = budget_keys / (2 * fan_in + 2);
+        for (size_t first = 0; ok && first < runs.size(); first += fan_in)
+        {
+            std::vector<std::string> group(runs.begin() + first, runs.begin() + std::min(runs.size(), first + fan_in));
+            std::string path = run_prefix + "p" + std::to_string(pass) + "_" + std::to_string(merged.size()) + ".run";
+            ok = mergeRunFiles(group, path, block_keys, stats);
+            merged.push_back(path);
+            for (const std::string& run : group)
+                std::remove(run.c_str());
+        }
+        runs.swap(merged);
+        stats.passes++;
+    }
+    if (ok)
+    {
+        size_t block_keys = budget_keys / (2 * runs.size() + 2);
+        ok = mergeRunFiles(runs, options.external_out, block_keys, stats);
+        stats.passes++;
+    }
+    for (const std::string& run : runs)
+        std::remove(run.c_str());
+    if (!ok)
+        return 2;
+
+    double total_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+    printf("Sorted %lld keys from %s into %s\n", stats.keys, options.external_in.c_str(), options.external_out.c_str());
+    printf("%d runs of up to %zu keys with %s, sorting took %.1f ms of %.1f ms\n", stats.runs, chunk_keys, engine->name, stats.sort_ms, runs_ms);
+    printf("%d merge pass(es) of up to %d runs, %.1f ms\n", stats.passes, fan_in, total_ms - runs_ms);
+    printf("Waited %.1f ms on the disk, %.1f ms total\n", stats.wait_ms, total_ms);
+    return 0;
+}
+
+//=================================================================================
+//      FONT CACHE
+//=================================================================================
+//
+// The SDL_Renderer backend can't take new glyphs once the atlas texture exists,
+// so ImGui rasterizes every glyph of the font before the first frame. This
+// loader sits in front of stb_truetype and keeps what it produced in
+// sortik_fonts.cache: for each font, size and DPI the glyph metrics and the
+// finished bitmaps. On a warm start glyphs are copied from there straight into
+// the atlas, and stb_truetype is only set up if a glyph is missing.
+// A font is told apart by a hash of its data and of the settings that change its
+// bitmaps. The file is dropped as a whole when the ImGui version changes.
+
+struct FontCacheHeader
+{
+    char     magic[8];   // "SRTKFNT"
+    uint32_t version;
+    uint32_t imgui_version;
+    uint32_t entries;
+};
+
+struct FontCacheGlyph
+{
+    uint32_t codepoint;
+    uint8_t  found;      // 0 - the font has no such glyph
+    uint8_t  visible;
+    uint16_t width;
+    uint16_t height;
+    float    advance_x, x0, y0, x1, y1;
+    uint32_t pixels;     // offset of the alpha bitmap in FontCacheEntry::pixels
+};
+
+struct FontCacheEntry
+{
+    uint64_t hash;
+    float    size;
+    float    density;
+    float    ascent;
+    float    descent;
+    std::vector<FontCacheGlyph> glyphs;  // sorted by codepoint
+    std::vector<uint8_t>        pixels;
+
+    const FontCacheGlyph* find(uint32_t codepoint) const
+    {
+        auto it = std::lower_bound(glyphs.begin(), glyphs.end(), codepoint,
+                                   [](const FontCacheGlyph& glyph, uint32_t c) { return glyph.codepoint < c; });
+        return it != glyphs.end() && it->codepoint == codepoint ? &*it : nullptr;
+    }
+};
+
+const char* font_cache_path = "sortik_fonts.cache";
+const uint32_t font_cache_version = 1;
+
+class FontCache
+{
+public:
+    // Counts in the file are only trusted as far as the bytes behind them go,
+    // anything that doesn't add up drops the whole file
+    bool load(const char* path)
+    {
+        FILE* file = fopen(path, "rb");
+        if (!file)
+            return false;
+        fseek(file, 0, SEEK_END);
+        long end = ftell(file);
+        rewind(file);
+        uint64_t left = end > 0 ? (uint64_t)end : 0;
+        auto take = [&](uint64_t bytes)
+        {
+            if (bytes > left)
+                return false;
+            left -= bytes;
+            return true;
+        };
+
+        const uint64_t entry_bytes = sizeof(uint64_t) + 4 * sizeof(float) + 2 * sizeof(uint32_t);
+        FontCacheHeader header;
+        bool ok = take(sizeof(header)) && fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, "SRTKFNT", 8) == 0
+               && header.version == font_cache_version && header.imgui_version == IMGUI_VERSION_NUM
+               && header.entries <= left / entry_bytes;
+        std::vector<FontCacheEntry> loaded(ok ? header.entries : 0);
+        for (FontCacheEntry& entry : loaded)
+        {
+            uint32_t glyphs = 0, pixels = 0;
+            ok = ok && take(entry_bytes) && fread(&entry.hash, sizeof(entry.hash), 1, file) == 1 && fread(&entry.size, sizeof(float), 4, file) == 4
+                    && fread(&glyphs, sizeof(glyphs), 1, file) == 1 && fread(&pixels, sizeof(pixels), 1, file) == 1
+                    && take((uint64_t)glyphs * sizeof(FontCacheGlyph) + pixels);
+            if (!ok)
+                break;
+            entry.glyphs.resize(glyphs);
+            entry.pixels.resize(pixels);
+            ok = fread(entry.glyphs.data(), sizeof(FontCacheGlyph), glyphs, file) == glyphs
+              && fread(entry.pixels.data(), 1, pixels, file) == pixels;
+            for (const FontCacheGlyph& glyph : entry.glyphs)
+                ok = ok && (uint64_t)glyph.pixels + (uint64_t)glyph.width * glyph.height <= pixels;
+        }
+        fclose(file);
+        if (ok)
+            entries = std::move(loaded);
+        return ok;
+    }
+
+    // Written next to the old file and renamed over it, so a failed save leaves it intact
+    bool save(const char* path)
+    {
+        std::string temp_path = std::string(path) + ".tmp";
+        FILE* file = fopen(temp_path.c_str(), "wb");
+        if (!file)
+            return false;
+        FontCacheHeader header = { "SRTKFNT", font_cache_version, IMGUI_VERSION_NUM, (uint32_t)entries.size() };
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        for (const FontCacheEntry& entry : entries)
+        {
+            uint32_t glyphs = (uint32_t)entry.glyphs.size(), pixels = (uint32_t)entry.pixels.size();
+            ok = ok && fwrite(&entry.hash, sizeof(entry.hash), 1, file) == 1 && fwrite(&entry.size, sizeof(float), 4, file) == 4
+                    && fwrite(&glyphs, sizeof(glyphs), 1, file) == 1 && fwrite(&pixels, sizeof(pixels), 1, file) == 1
+                    && fwrite(entry.glyphs.data(), sizeof(FontCacheGlyph), glyphs, file) == glyphs
+                    && fwrite(entry.pixels.data(), 1, pixels, file) == pixels;
+        }
+        ok = fclose(file) == 0 && ok;
+#ifdef _WIN32
+        // rename() won't replace an existing file there
+        ok = ok && (std::remove(path) == 0 || errno == ENOENT);
+#endif
+        ok = ok && std::rename(temp_path.c_str(), path) == 0;
+        if (!ok)
+            std::remove(temp_path.c_str());
+        dirty = false;
+        return ok;
+    }
+
+    FontCacheEntry* find(uint64_t hash, float size, float density)
+    {
+        for (FontCacheEntry& entry : entries)
+            if (entry.hash == hash && entry.size == size && entry.density == density)
+                return &entry;
+        return nullptr;
+    }
+
+    FontCacheEntry& add(uint64_t hash, float size, float density)
+    {
+        FontCacheEntry* entry = find(hash, size, density);
+        if (entry)
+            return *entry;
+        entries.push_back({ hash, size, density, 0.0f, 0.0f, {}, {} });
+        dirty = true;
+        return entries.back();
     }
-}
 
-bool verifyArrayIsSorted(int*& array, const int number)
-{
-    for (int i = 0; i < number; i++)
+    void record(FontCacheEntry& entry, const FontCacheGlyph& glyph, const uint8_t* pixels)
     {
-        if (array[i] != i)
-            return 0;
+        FontCacheGlyph stored = glyph;
+        stored.pixels = (uint32_t)entry.pixels.size();
+        entry.pixels.insert(entry.pixels.end(), pixels, pixels + (size_t)glyph.width * glyph.height);
+        auto it = std::lower_bound(entry.glyphs.begin(), entry.glyphs.end(), glyph.codepoint,
+                                   [](const FontCacheGlyph& g, uint32_t c) { return g.codepoint < c; });
+        entry.glyphs.insert(it, stored);
+        dirty = true;
     }
-    return 1;
-}
 
-//---------------------------------------------------------------------------------
-//      SORTS
-//---------------------------------------------------------------------------------
+    bool dirty = false;
+    int  copied = 0;        // glyphs taken from the cache this run
+    int  rasterized = 0;    // glyphs stb_truetype had to make
 
-std::mutex numbers_mutex;
+private:
+    std::vector<FontCacheEntry> entries;
+};
 
-//------BOGO-----------------------------------------------------------------------
-std::mutex bogo_numbers_mutex;
-std::future<void> bogo_future;
-std::atomic<int> bogo_iterations(0);
-std::atomic<double> bogo_sort_time_ms(0.0);
-std::chrono::time_point<std::chrono::high_resolution_clock> bogo_start_time;
+FontCache font_cache;
 
-void bogoSort(int* array, const int number, std::atomic<int>& iter_count, std::atomic<double>& sort_time_ms)
+// Per font source, stb_truetype's own data only exists after the first miss
+struct FontCacheSource
 {
-    iter_count = 0;
-    auto start_time = std::chrono::high_resolution_clock::now();
+    uint64_t hash;
+    void*    stb_data = nullptr;
+    bool     stb_ready = false;
+};
 
-    while (true) {
-        iter_count++;
-        {
-            std::lock_guard<std::mutex> lock(bogo_numbers_mutex);
-            if (verifyArrayIsSorted(array, number))
-                break;
-            shuffleIntArray(number, array);
-        }
-        std::this_thread::yield();
-    }
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-    sort_time_ms = duration.count();
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    return hash;
 }
 
-//------SHELL----------------------------------------------------------------------
-std::mutex shell_numbers_mutex;
-std::future<void> shell_future;
-std::atomic<int> shell_operations(0);
-std::atomic<double> shell_sort_time_ms(0.0);
-std::chrono::time_point<std::chrono::high_resolution_clock> shell_start_time;
+template <typename T>
+uint64_t fnv1a(uint64_t hash, const T& value) { return fnv1a(&value, sizeof(value), hash); }
 
-void shellSort(int* array, const int number, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+uint64_t fontSourceHash(const ImFontConfig* src)
 {
-    oper_count = 0;
-    auto start_time = std::chrono::high_resolution_clock::now();
-    
-    // Start with a big gap, then reduce the gap
-    for (int gap = number/2; gap > 0; gap /= 2)
-    {
-        // Do a gapped insertion sort for this gap size.
-        // The first gap elements a[0..gap-1] are already in gapped order
-        // keep adding one more element until the entire array is
-        // gap sorted 
-        for (int i = gap; i < number; i += 1)
-        {
-            // add a[i] to the elements that have been gap sorted
-            // save a[i] in temp and make a hole at position i
-            int temp = array[i];
-
-            // shift earlier gap-sorted elements up until the correct 
-            // location for a[i] is found
-            int j;
-            
-            for (j = i; j >= gap && array[j - gap] > temp; j -= gap)
-            {
-                array[j] = array[j - gap];
-                oper_count++;
-            }
+    uint64_t hash = fnv1a(src->FontData, (size_t)src->FontDataSize);
+    hash = fnv1a(hash, src->FontNo);
+    hash = fnv1a(hash, src->SizePixels);
+    hash = fnv1a(hash, src->DstFont && !src->DstFont->Sources.empty() ? src->DstFont->Sources[0]->SizePixels : 0.0f);
+    hash = fnv1a(hash, src->MergeMode);
+    hash = fnv1a(hash, src->OversampleH);
+    hash = fnv1a(hash, src->OversampleV);
+    hash = fnv1a(hash, src->PixelSnapH);
+    hash = fnv1a(hash, src->PixelSnapV);
+    hash = fnv1a(hash, src->GlyphOffset.x);
+    hash = fnv1a(hash, src->GlyphOffset.y);
+    hash = fnv1a(hash, src->RasterizerMultiply);
+    return hash;
+}
 
-            //  put temp (the original a[i]) in its correct location
-            array[j] = temp;
-            oper_count++;
-            
-            std::this_thread::yield();
-        }
+// Runs one stb_truetype call with its own data in src, setting it up first if needed
+template <typename Call>
+bool withStbTrueType(ImFontAtlas* atlas, ImFontConfig* src, Call call)
+{
+    const ImFontLoader* stb = ImFontAtlasGetFontLoaderForStbTruetype();
+    FontCacheSource* source = (FontCacheSource*)src->FontLoaderData;
+    src->FontLoaderData = source->stb_data;
+    if (!source->stb_ready)
+    {
+        source->stb_ready = stb->FontSrcInit(atlas, src);
+        source->stb_data = src->FontLoaderData;
     }
-    
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-    sort_time_ms = duration.count();
+    bool ok = source->stb_ready && call(stb);
+    src->FontLoaderData = source;
+    return ok;
 }
 
-//------RADIX----------------------------------------------------------------------
-std::mutex radix_numbers_mutex;
-std::future<void> radix_future;
-std::atomic<int> radix_operations(0);
-std::atomic<double> radix_sort_time_ms(0.0);
-std::chrono::time_point<std::chrono::high_resolution_clock> radix_start_time;
+bool fontCacheSrcInit(ImFontAtlas*, ImFontConfig* src)
+{
+    // What stb_truetype's init does to merged sources, it may not run at all
+    if (src->MergeMode && src->SizePixels == 0.0f)
+        src->SizePixels = src->DstFont->Sources[0]->SizePixels;
+    FontCacheSource* source = IM_NEW(FontCacheSource);
+    source->hash = fontSourceHash(src);
+    src->FontLoaderData = source;
+    return true;
+}
 
-int getMax(int* arr, int n)
+void fontCacheSrcDestroy(ImFontAtlas* atlas, ImFontConfig* src)
 {
-    int mx = arr[0];
-    for (int i = 1; i < n; i++) {
-        if (arr[i] > mx)
-            mx = arr[i];
-        radix_operations++;
+    FontCacheSource* source = (FontCacheSource*)src->FontLoaderData;
+    if (!source)
+        return;
+    if (source->stb_ready)
+    {
+        src->FontLoaderData = source->stb_data;
+        ImFontAtlasGetFontLoaderForStbTruetype()->FontSrcDestroy(atlas, src);
     }
-    return mx;
+    IM_DELETE(source);
+    src->FontLoaderData = nullptr;
 }
 
-// A function to do counting sort of arr[]
-// according to the digit
-// represented by exp.
-void countSort(int* arr, int n, int exp, std::atomic<int>& oper_count)
+bool fontCacheSrcContainsGlyph(ImFontAtlas* atlas, ImFontConfig* src, ImWchar codepoint)
 {
-    // Use dynamic allocation instead of VLA (Variable Length Array)
-    int* output = new int[n];
-    int count[10] = { 0 };
+    return withStbTrueType(atlas, src, [&](const ImFontLoader* stb) { return stb->FontSrcContainsGlyph(atlas, src, codepoint); });
+}
 
-    // Store count of occurrences
-    for (int i = 0; i < n; i++) {
-        count[(arr[i] / exp) % 10]++;
-        oper_count++;
-    }
+float fontCacheDensity(const ImFontConfig* src, const ImFontBaked* baked)
+{
+    return src->RasterizerDensity * baked->RasterizerDensity;
+}
 
-    // Change count[i] to contain actual position
-    for (int i = 1; i < 10; i++) {
-        count[i] += count[i - 1];
-        oper_count++;
+bool fontCacheBakedInit(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void* loader_data)
+{
+    const FontCacheSource* source = (const FontCacheSource*)src->FontLoaderData;
+    if (src->MergeMode)
+        return true;
+    if (const FontCacheEntry* entry = font_cache.find(source->hash, baked->Size, fontCacheDensity(src, baked)))
+    {
+        baked->Ascent = entry->ascent;
+        baked->Descent = entry->descent;
+        return true;
     }
+    if (!withStbTrueType(atlas, src, [&](const ImFontLoader* stb) { return stb->FontBakedInit(atlas, src, baked, loader_data); }))
+        return false;
+    FontCacheEntry& entry = font_cache.add(source->hash, baked->Size, fontCacheDensity(src, baked));
+    entry.ascent = baked->Ascent;
+    entry.descent = baked->Descent;
+    return true;
+}
 
-    // Build the output array
-    for (int i = n - 1; i >= 0; i--) {
-        output[count[(arr[i] / exp) % 10] - 1] = arr[i];
-        count[(arr[i] / exp) % 10]--;
-        oper_count++;
+bool fontCacheBakedLoadGlyph(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void* loader_data, ImWchar codepoint, ImFontGlyph* out_glyph, float* out_advance_x)
+{
+    const FontCacheSource* source = (const FontCacheSource*)src->FontLoaderData;
+    FontCacheEntry* entry = font_cache.find(source->hash, baked->Size, fontCacheDensity(src, baked));
+    const FontCacheGlyph* cached = entry ? entry->find(codepoint) : nullptr;
+    if (cached)
+    {
+        font_cache.copied++;
+        if (!cached->found)
+            return false;
+        if (out_advance_x)
+        {
+            *out_advance_x = cached->advance_x;
+            return true;
+        }
+        out_glyph->Codepoint = codepoint;
+        out_glyph->AdvanceX = cached->advance_x;
+        if (!cached->visible)
+            return true;
+        ImFontAtlasRectId pack_id = ImFontAtlasPackAddRect(atlas, cached->width, cached->height);
+        if (pack_id == ImFontAtlasRectId_Invalid)
+            return false;
+        ImTextureRect* r = ImFontAtlasPackGetRect(atlas, pack_id);
+        out_glyph->X0 = cached->x0;
+        out_glyph->Y0 = cached->y0;
+        out_glyph->X1 = cached->x1;
+        out_glyph->Y1 = cached->y1;
+        out_glyph->Visible = true;
+        out_glyph->PackId = pack_id;
+        // Cached bitmaps are already post-processed, so they skip ImFontAtlasBakedSetFontGlyphBitmap()
+        ImTextureData* tex = atlas->TexData;
+        ImFontAtlasTextureBlockConvert(entry->pixels.data() + cached->pixels, ImTextureFormat_Alpha8, cached->width,
+                                       (unsigned char*)tex->GetPixelsAt(r->x, r->y), tex->Format, tex->GetPitch(), r->w, r->h);
+        ImFontAtlasTextureBlockQueueUpload(atlas, tex, r->x, r->y, r->w, r->h);
+        return true;
     }
 
-    // Copy the output array to arr[]
-    for (int i = 0; i < n; i++) {
-        arr[i] = output[i];
-        oper_count++;
+    // Only whole glyphs are kept, a metrics-only load is answered but not cached
+    bool found = withStbTrueType(atlas, src, [&](const ImFontLoader* stb)
+                                 { return stb->FontBakedLoadGlyph(atlas, src, baked, loader_data, codepoint, out_glyph, out_advance_x); });
+    if (out_advance_x)
+        return found;
+    // stb_truetype also fails on a full atlas or a font it can't open, only a
+    // glyph the font really lacks is remembered as missing
+    if (!found && (!source->stb_ready || fontCacheSrcContainsGlyph(atlas, src, codepoint)))
+        return false;
+    if (!entry)
+        entry = &font_cache.add(source->hash, baked->Size, fontCacheDensity(src, baked));
+    font_cache.rasterized++;
+    FontCacheGlyph glyph = {};
+    glyph.codepoint = codepoint;
+    glyph.found = found;
+    std::vector<uint8_t> alpha;
+    if (found)
+    {
+        glyph.visible = out_glyph->Visible;
+        glyph.advance_x = out_glyph->AdvanceX;
+        glyph.x0 = out_glyph->X0;
+        glyph.y0 = out_glyph->Y0;
+        glyph.x1 = out_glyph->X1;
+        glyph.y1 = out_glyph->Y1;
+        if (glyph.visible)
+        {
+            // Read back what landed in the atlas, after any post-processing
+            ImTextureRect* r = ImFontAtlasPackGetRect(atlas, out_glyph->PackId);
+            ImTextureData* tex = atlas->TexData;
+            glyph.width = r->w;
+            glyph.height = r->h;
+            alpha.resize((size_t)r->w * r->h);
+            for (int y = 0; y < r->h; y++)
+                for (int x = 0; x < r->w; x++)
+                {
+                    const uint8_t* pixel = (const uint8_t*)tex->GetPixelsAt(r->x + x, r->y + y);
+                    alpha[(size_t)y * r->w + x] = tex->Format == ImTextureFormat_RGBA32 ? pixel[3] : pixel[0];
+                }
+        }
     }
-    
-    delete[] output;
+    font_cache.record(*entry, glyph, alpha.data());
+    return found;
 }
 
-void radixSort(int* arr, int n, std::atomic<int>& oper_count, std::atomic<double>& sort_time_ms)
+const ImFontLoader* fontCacheLoader()
 {
-    oper_count = 0;
-    auto start_time = std::chrono::high_resolution_clock::now();
+    static ImFontLoader loader;
+    loader.Name = "sortik_font_cache";
+    loader.FontSrcInit = fontCacheSrcInit;
+    loader.FontSrcDestroy = fontCacheSrcDestroy;
+    loader.FontSrcContainsGlyph = fontCacheSrcContainsGlyph;
+    loader.FontBakedInit = fontCacheBakedInit;
+    loader.FontBakedLoadGlyph = fontCacheBakedLoadGlyph;
+    loader.FontBakedSrcLoaderDataSize = ImFontAtlasGetFontLoaderForStbTruetype()->FontBakedSrcLoaderDataSize;
+    return &loader;
+}
 
-    // Find the maximum number to know number of digits
-    int m = getMax(arr, n);
+// The UI font is the one AddFontDefault() would add, but stored as an LZ4 block
+// (fonts/binary_to_compressed_c -lz4) that unpacks on a worker thread while SDL
+// starts instead of on the main thread when the atlas is first built.
 
-    // Do counting sort for every digit
-    for (int exp = 1; m / exp > 0; exp *= 10) {
-        {
-            std::lock_guard<std::mutex> lock(radix_numbers_mutex);
-            countSort(arr, n, exp, oper_count);
-        }
+// Copies run 16 bytes at a time and may write up to this far past the output
+const size_t lz4_slack = 32;
 
-        std::this_thread::yield();
-    }
+// Decodes one "LZ4B" block into out, which has room for the decoded size plus
+// lz4_slack. False on anything malformed.
+bool lz4Decompress(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size)
+{
+    const uint8_t* ip = in;
+    const uint8_t* in_end = in + in_size;
+    uint8_t* op = out;
+    uint8_t* out_end = out + out_size;
+    auto length = [&](size_t& value)
+    {
+        uint8_t byte;
+        do
+        {
+            if (ip >= in_end)
+                return false;
+            byte = *ip++;
+            value += byte;
+        } while (byte == 255);
+        return true;
+    };
 
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-    sort_time_ms = duration.count();
-}
+    while (ip < in_end)
+    {
+        unsigned token = *ip++;
+        size_t literals = token >> 4;
+        if (literals == 15 && !length(literals))
+            return false;
+        if (literals > (size_t)(in_end - ip) || literals > (size_t)(out_end - op))
+            return false;
+        if (literals <= 16 && in_end - ip >= 16)
+            memcpy(op, ip, 16);
+        else
+            memcpy(op, ip, literals);
+        op += literals;
+        ip += literals;
+        if (ip == in_end)
+            break;  // the last sequence has no match
 
-//---------------------------------------------------------------------------------
-//---------------------------------------------------------------------------------
+        if (in_end - ip < 2)
+            return false;
+        size_t offset = ip[0] | (size_t)ip[1] << 8;
+        ip += 2;
+        size_t match = token & 15;
+        if (match == 15 && !length(match))
+            return false;
+        match += 4;
+        if (offset == 0 || offset > (size_t)(op - out) || match > (size_t)(out_end - op))
+            return false;
 
-std::vector<int> downsampleArray(const int* data, int original_size) {
-    int max_points = 100000;
-    std::vector<int> downsampled;
-    if (original_size <= max_points) {
-        // No need to downsample
-        downsampled.assign(data, data + original_size);
-        return downsampled;
-    }
-    
-    // Calculate sampling rate
-    int step = original_size / max_points;
-    if (step < 1) step = 1;
-    
-    // Sample the data
-    downsampled.reserve(max_points);
-    for (int i = 0; i < original_size; i += step) {
-        downsampled.push_back(data[i]);
+        const uint8_t* from = op - offset;
+        size_t step = offset >= 16 ? 16 : offset >= 8 ? 8 : 0;
+        if (step)
+        {
+            // Each chunk reads only bytes already written
+            for (size_t copied = 0; copied < match; copied += step)
+                memcpy(op + copied, from + copied, step);
+        }
+        else
+        {
+            // Overlapping, the match repeats the last offset bytes
+            for (size_t i = 0; i < match; i++)
+                op[i] = from[i];
+        }
+        op += match;
     }
-    
-    return downsampled;
+    return op == out_end;
 }
 
-#ifdef DEVELOPER_OPTIONS
-std::string debug_array(const int* array, const int number)
+std::vector<uint8_t> unpackEmbeddedFont()
 {
-    std::string info;
-    for (int i = 0; i < number; i++)
+    const uint8_t* block = ProggyClean_lz4_data;
+    std::vector<uint8_t> font;
+    if (ProggyClean_lz4_size < 8 || memcmp(block, "LZ4B", 4) != 0)
+        return font;
+    size_t size = block[4] | (size_t)block[5] << 8 | (size_t)block[6] << 16 | (size_t)block[7] << 24;
+    font.resize(size + lz4_slack);
+    if (!lz4Decompress(block + 8, ProggyClean_lz4_size - 8, font.data(), size))
+        font.clear();
+    font.resize(font.empty() ? 0 : size);
+    return font;
+}
+
+// Same settings as AddFontDefault(), so the font cache entry stays the same too.
+// The atlas doesn't own the data, it has to outlive the ImGui context.
+void addEmbeddedFont(ImFontAtlas* atlas, std::vector<uint8_t>& font)
+{
+    if (font.empty())
     {
-        info += std::to_string(array[i]) + " ";
+        atlas->AddFontDefault();
+        return;
     }
-    return info;
+    ImFontConfig config;
+    config.FontDataOwnedByAtlas = false;
+    config.OversampleH = config.OversampleV = 1;
+    config.PixelSnapH = true;
+    config.EllipsisChar = (ImWchar)0x0085;
+    config.GlyphOffset.y = 1.0f;
+    snprintf(config.Name, sizeof(config.Name), "ProggyClean.ttf");
+    atlas->AddFontFromMemoryTTF(font.data(), (int)font.size(), 13.0f, &config);
 }
-#endif
 
 //=================================================================================
 //      SDL SETUP
@@ -295,8 +6244,15 @@ void renderWindow(SDL_Renderer* renderer, ImGuiIO& io, int transparent_colorref
 //      START OF THE MAIN CODE
 //---------------------------------------------------------------------------------
 
-int main(int, char**)
+int main(int argc, char** argv)
 {
+    BenchOptions bench_options;
+    if (parseBenchArgs(argc, argv, bench_options))
+        return bench_options.external_in.empty() ? runHeadlessBenchmark(bench_options) : runExternalSort(bench_options);
+
+    // Unpacked by the time the ImGui context wants it
+    std::future<std::vector<uint8_t>> embedded_font = std::async(std::launch::async, unpackEmbeddedFont);
+
     // Setup SDL
 #ifdef _WIN32
     ::SetProcessDPIAware();
@@ -338,6 +6294,12 @@ int main(int, char**)
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
 
+    // Glyphs rasterized on an earlier run come from the cache file
+    font_cache.load(font_cache_path);
+    io.Fonts->SetFontLoader(fontCacheLoader());
+    std::vector<uint8_t> font_data = embedded_font.get();
+    addEmbeddedFont(io.Fonts, font_data);
+
     // Setup Platform/Renderer backends
     ImGui_ImplSDL2_InitForSDLRenderer(window, renderer);
     ImGui_ImplSDLRenderer2_Init(renderer);
@@ -475,7 +6437,23 @@ int main(int, char**)
     bool show_shellsort_window = false;
     bool show_radixsort_window = false;
     bool show_bogosort_window = false;
+    bool show_picked_window = false;
+    int picked_engine = (int)(findEngine("auto") - bench_engines);
+    int picked_k = 100;
+    std::vector<int> stability_results(sizeof(bench_engines) / sizeof(bench_engines[0]), -1);  // -1 not checked, 0 failed, 1 passed
     bool render_charts = true;
+    int array_view = ArrayView_Bars;
+    ArrayTexture shell_texture, radix_texture, bogo_texture, picked_texture, replay_texture;
+    bool record_traces = false;
+
+    TraceReplay replay;
+    char replay_path[256] = "shell_trace.srt";
+    bool replay_failed = false;
+    int replay_direction = 0;   // -1 - backward, 0 - paused, 1 - forward
+    int replay_speed = 100;     // operations per frame
+
+    char dataset_path[256] = "keys.bin";
+    std::string dataset_status;
 
 
     int number_of_numbers = 1000;
@@ -483,15 +6461,52 @@ int main(int, char**)
     int* shell_numbers;
     int* radix_numbers;
     int* bogo_numbers;
+    int* picked_numbers;
     updateIntArray(number_of_numbers, numbers);
     copyPasteArray(number_of_numbers, numbers, shell_numbers);
     copyPasteArray(number_of_numbers, numbers, radix_numbers);
     copyPasteArray(number_of_numbers, numbers, bogo_numbers);
+    copyPasteArray(number_of_numbers, numbers, picked_numbers);
+
+    // First start on this machine measures the auto engine's thresholds
+    std::future<void> auto_tuning_future = std::async(std::launch::async, [] { autoTuning(); });
+
+    ProgressSampler sampler;
+    int shell_channel = sampler.addChannel("Shellsort", &shell_operations, &shell_dirty);
+    int radix_channel = sampler.addChannel("Radix Sort", &radix_operations, &radix_dirty);
+    int bogo_channel = sampler.addChannel("Bogosort", &bogo_iterations, &bogo_dirty);
+    int picked_channel = sampler.addChannel("Picked engine", &picked_operations, &picked_dirty);
+    int sample_rate_hz = sampler.rate_hz;
+    bool show_throughput_window = false;
+    std::vector<ProgressSample> progress;
+    std::vector<double> progress_time, progress_rate, progress_sortedness;
+    std::vector<double> progress_inversions, progress_runs, progress_displacement, progress_lis;
+    std::vector<float> occupancy_values;
+    sampler.start();
+
+    // What the chart consumers last drew, anything else means redraw everything
+    ArraySamples shell_samples, radix_samples, bogo_samples, picked_samples, replay_samples;
+    int drawn_view = -1;
+    auto resetDirty = [&]()
+    {
+        shell_dirty.reset(number_of_numbers);
+        radix_dirty.reset(number_of_numbers);
+        bogo_dirty.reset(number_of_numbers);
+        picked_dirty.reset(number_of_numbers);
+        replay.dirty.markAll();
+    };
+    resetDirty();
 
 //=================================================================================
 //      START OF THE MAIN LOOP
 //=================================================================================
 
+    const int settle_frames = 3;
+    const int idle_timeout_ms = 500;
+    int idle_frames = 0;
+    bool benchmark_mode = false;
+    int benchmark_fps = 5;
+
     bool done = false;
     while (!done)
     {
@@ -500,15 +6515,45 @@ int main(int, char**)
         // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
         // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or clear/overwrite your copy of the keyboard data.
         // Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
+        //
+        // Nothing moves on screen unless a sort or a replay is running or the user
+        // does something, so when idle block until the next event instead of
+        // redrawing at VSYNC rate. Benchmark mode also slows redraws down while
+        // sorts run, to leave the cores to them.
+        bool sorting = false;
+        for (auto run : { std::make_pair(&shell_future, shell_channel), std::make_pair(&radix_future, radix_channel), std::make_pair(&bogo_future, bogo_channel),
+                          std::make_pair(&picked_future, picked_channel) })
+        {
+            if (isRunning(*run.first))
+                sorting = true;
+            else
+                sampler.endRun(run.second);
+        }
+        bool animating = sorting || replay_direction != 0;
+        if (animating)
+            idle_frames = 0;
+
         SDL_Event event;
-        while (SDL_PollEvent(&event))
+        int have_event;
+        if (idle_frames >= settle_frames)
+            have_event = SDL_WaitEventTimeout(&event, idle_timeout_ms);
+        else if (benchmark_mode && sorting)
+            have_event = SDL_WaitEventTimeout(&event, 1000 / benchmark_fps);
+        else
+            have_event = SDL_PollEvent(&event);
+
+        while (have_event)
         {
+            // ImGui needs a few frames after input to settle hover and popups
+            idle_frames = 0;
             ImGui_ImplSDL2_ProcessEvent(&event);
             if (event.type == SDL_QUIT)
                 done = true;
             if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE && event.window.windowID == SDL_GetWindowID(window))
                 done = true;
+            have_event = SDL_PollEvent(&event);
         }
+        idle_frames++;
         if (SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED)
         {
             SDL_Delay(10);
@@ -517,6 +6562,9 @@ int main(int, char**)
 
         // Start the Dear ImGui frame
         ImGui_ImplSDLRenderer2_NewFrame();
+        // The first frame builds the atlas, whatever stb_truetype made goes to the cache once
+        if (font_cache.dirty && !font_cache.save(font_cache_path))
+            fprintf(stderr, "Can't write %s\n", font_cache_path);
         ImGui_ImplSDL2_NewFrame();
         ImGui::NewFrame();
 
@@ -539,6 +6587,18 @@ int main(int, char**)
                 copyPasteArray(number_of_numbers, numbers, shell_numbers);
                 copyPasteArray(number_of_numbers, numbers, radix_numbers);
                 copyPasteArray(number_of_numbers, numbers, bogo_numbers);
+                copyPasteArray(number_of_numbers, numbers, picked_numbers);
+                resetDirty();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Nearly Sorted"))
+            {
+                nearlySortIntArray(number_of_numbers, numbers, rnd);
+                copyPasteArray(number_of_numbers, numbers, shell_numbers);
+                copyPasteArray(number_of_numbers, numbers, radix_numbers);
+                copyPasteArray(number_of_numbers, numbers, bogo_numbers);
+                copyPasteArray(number_of_numbers, numbers, picked_numbers);
+                resetDirty();
             }
             ImGui::SameLine();
             if (ImGui::Button("Beggin Sort"))
@@ -550,23 +6610,28 @@ int main(int, char**)
                         shell_operations = 0;
                         shell_sort_time_ms = 0.0;
                         shell_start_time = std::chrono::high_resolution_clock::now();
-                        shell_future = std::async(std::launch::async, shellSort, 
+                        shell_future = std::async(std::launch::async, trackedSort, shellSort, &shell_dirty,
+                                                record_traces ? std::string("shell_trace.srt") : std::string(),
                                                 shell_numbers, number_of_numbers, 
                                                 std::ref(shell_operations), 
                                                 std::ref(shell_sort_time_ms));
+                        sampler.beginRun(shell_channel, shell_numbers, number_of_numbers);
                     }
                 if (show_radixsort_window)
                     if (!radix_future.valid() || radix_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
                     {
                         std::lock_guard<std::mutex> lock(radix_numbers_mutex);
                         shuffleIntArray(number_of_numbers, radix_numbers);
+                        radix_dirty.markAll();
                         radix_operations = 0;
                         radix_sort_time_ms = 0.0;
                         radix_start_time = std::chrono::high_resolution_clock::now();
-                        radix_future = std::async(std::launch::async, radixSort, 
+                        radix_future = std::async(std::launch::async, trackedSort, radixSort, &radix_dirty,
+                                                record_traces ? std::string("radix_trace.srt") : std::string(),
                                                 radix_numbers, number_of_numbers, 
                                                 std::ref(radix_operations), 
                                                 std::ref(radix_sort_time_ms));
+                        sampler.beginRun(radix_channel, radix_numbers, number_of_numbers);
                     }
                 if (show_bogosort_window)
                     if (!bogo_future.valid() || bogo_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
@@ -575,10 +6640,25 @@ int main(int, char**)
                         bogo_iterations = 0;
                         bogo_sort_time_ms = 0.0;
                         bogo_start_time = std::chrono::high_resolution_clock::now();
-                        bogo_future = std::async(std::launch::async, bogoSort, 
+                        bogo_future = std::async(std::launch::async, trackedSort, bogoSort, &bogo_dirty,
+                                                record_traces ? std::string("bogo_trace.srt") : std::string(),
                                                 bogo_numbers, number_of_numbers, 
                                                 std::ref(bogo_iterations), 
                                                 std::ref(bogo_sort_time_ms));
+                        sampler.beginRun(bogo_channel, bogo_numbers, number_of_numbers);
+                    }
+                if (show_picked_window)
+                    if (!isRunning(picked_future))
+                    {
+                        picked_operations = 0;
+                        picked_sort_time_ms = 0.0;
+                        picked_start_time = std::chrono::high_resolution_clock::now();
+                        picked_future = std::async(std::launch::async, trackedSelect, picked_k, bench_engines[picked_engine].sort, &picked_dirty,
+                                                record_traces ? std::string(bench_engines[picked_engine].name) + "_trace.srt" : std::string(),
+                                                picked_numbers, number_of_numbers,
+                                                std::ref(picked_operations),
+                                                std::ref(picked_sort_time_ms));
+                        sampler.beginRun(picked_channel, picked_numbers, number_of_numbers);
                     }
 
             }
@@ -590,6 +6670,8 @@ int main(int, char**)
                 copyPasteArray(number_of_numbers, numbers, shell_numbers);
                 copyPasteArray(number_of_numbers, numbers, radix_numbers);
                 copyPasteArray(number_of_numbers, numbers, bogo_numbers);
+                copyPasteArray(number_of_numbers, numbers, picked_numbers);
+                resetDirty();
             }
 
             ImGui::SeparatorText("Shell Sort");
@@ -652,8 +6734,122 @@ int main(int, char**)
                     ImGui::Text("Time: %.2f sec, Iterations: %d", elapsed_ms / 1000.0, iterations);
                 }
             }
+            ImGui::SeparatorText("Picked Engine");
+            ImGui::Checkbox("Do##4", &show_picked_window);
+            ImGui::SameLine();
+            ImGui::Combo("Engine", &picked_engine, [](void*, int index) { return bench_engines[index].name; },
+                         nullptr, (int)(sizeof(bench_engines) / sizeof(bench_engines[0])));
+            if (picked_future.valid())
+            {
+                double elapsed_ms = isRunning(picked_future)
+                    ? std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - picked_start_time).count()
+                    : picked_sort_time_ms.load();
+                ImGui::Text("Time: %.2f sec, Operations: %d", elapsed_ms / 1000.0, picked_operations.load());
+            }
+            if (bench_engines[picked_engine].sort == autoSort)
+            {
+                std::lock_guard<std::mutex> lock(auto_choice_mutex);
+                ImGui::Text("Auto: %s", auto_choice.empty() ? "not run yet" : auto_choice.c_str());
+            }
+            if (bench_engines[picked_engine].select != Select_None)
+                ImGui::SliderInt("k", &picked_k, 1, std::max(1, number_of_numbers), nullptr, ImGuiSliderFlags_Logarithmic);
+            if (bench_engines[picked_engine].sort == timSortEngine && picked_future.valid() && !isRunning(picked_future))
+            {
+                std::lock_guard<std::mutex> lock(tim_metrics_mutex);
+                ImGui::Text("Runs: %lld (mean length %.1f), galloping %lld times, %lld hits moving %lld keys", tim_metrics.runs,
+                            (double)number_of_numbers / std::max(1LL, tim_metrics.runs), tim_metrics.galloping, tim_metrics.gallop_hits, tim_metrics.galloped_keys);
+            }
+            if (bench_engines[picked_engine].stability_check)
+            {
+                int& result = stability_results[picked_engine];
+                if (ImGui::Button("Check stability"))
+                    result = bench_engines[picked_engine].stability_check() ? 1 : 0;
+                ImGui::SameLine();
+                ImGui::TextUnformatted(result < 0 ? "not checked" : result ? "equal keys kept their order" : "equal keys were reordered!");
+            }
+            ImGui::SeparatorText("Replay");
+            ImGui::InputText("Trace file", replay_path, sizeof(replay_path));
+            ImGui::SameLine();
+            if (ImGui::Button("Open"))
+            {
+                replay_failed = !replay.open(replay_path);
+                replay_direction = 0;
+            }
+            if (replay_failed)
+                ImGui::Text("Can't open %s", replay_path);
+            if (replay.isOpen())
+            {
+                if (ImGui::Button("<<"))
+                    replay_direction = -1;
+                ImGui::SameLine();
+                if (ImGui::Button("||"))
+                    replay_direction = 0;
+                ImGui::SameLine();
+                if (ImGui::Button(">>"))
+                    replay_direction = 1;
+                ImGui::SameLine();
+                if (ImGui::Button("Close##replay"))
+                    replay.close();
+                ImGui::SliderInt("Operations per frame", &replay_speed, 1, 1000000, nullptr, ImGuiSliderFlags_Logarithmic);
+
+                uint64_t position = replay.position, first = 0;
+                if (ImGui::SliderScalar("Operation", ImGuiDataType_U64, &position, &first, &replay.operations))
+                {
+                    replay.seek(position);
+                    replay_direction = 0;
+                }
+                ImGui::Text("%d numbers, checkpoint every %llu operations", replay.number, (unsigned long long)replay.interval);
+            }
+            ImGui::SeparatorText("Dataset");
+            ImGui::InputText("Key file", dataset_path, sizeof(dataset_path));
+            ImGui::SameLine();
+            if (ImGui::Button("Load"))
+            {
+                Dataset dataset;
+                if (!dataset.open(dataset_path, false))
+                    dataset_status = std::string("Can't open ") + dataset_path;
+                else if (!dataset.ints() || dataset.header.count == 0 || dataset.header.count > INT_MAX)
+                    dataset_status = std::string("Only 1 to 2^31-1 int32 keys can be shown, it has ") + std::to_string(dataset.header.count)
+                                   + " " + dataset_type_names[dataset.header.type];
+                else
+                {
+                    number_of_numbers = (int)dataset.header.count;
+                    numbers = allocKeys(number_of_numbers);
+                    memcpy(numbers, dataset.ints(), (size_t)number_of_numbers * sizeof(int));
+                    copyPasteArray(number_of_numbers, numbers, shell_numbers);
+                    copyPasteArray(number_of_numbers, numbers, radix_numbers);
+                    copyPasteArray(number_of_numbers, numbers, bogo_numbers);
+                    copyPasteArray(number_of_numbers, numbers, picked_numbers);
+                    resetDirty();
+                    dataset_status = "Loaded " + std::to_string(number_of_numbers) + " keys, seed " + std::to_string(dataset.header.seed);
+                }
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Save"))
+                dataset_status = saveDataset(dataset_path, numbers, (uint64_t)number_of_numbers, 0)
+                               ? "Saved " + std::to_string(number_of_numbers) + " keys" : std::string("Can't write ") + dataset_path;
+            if (!dataset_status.empty())
+                ImGui::TextUnformatted(dataset_status.c_str());
+
             ImGui::Separator();
+            ImGui::Checkbox("Show throughput", &show_throughput_window);
+            if (show_throughput_window)
+            {
+                ImGui::SameLine();
+                if (ImGui::SliderInt("Samples per second", &sample_rate_hz, 1, 1000, nullptr, ImGuiSliderFlags_Logarithmic))
+                    sampler.rate_hz = sample_rate_hz;
+            }
+            ImGui::Checkbox("Benchmark mode", &benchmark_mode);
+            if (benchmark_mode)
+            {
+                ImGui::SameLine();
+                ImGui::SliderInt("Redraws per second while sorting", &benchmark_fps, 1, 30);
+            }
             ImGui::Checkbox("Render charts", &render_charts);
+            ImGui::SameLine();
+            ImGui::Combo("View", &array_view, "Bars\0Dots\0Heatmap\0");
+            ImGui::SameLine();
+            ImGui::Checkbox("Record traces", &record_traces);
 
         #ifdef DEVELOPER_OPTIONS
             ImGui::Checkbox("ImGui Demo Window", &show_demo_window);
@@ -668,39 +6864,177 @@ int main(int, char**)
             ImGui::End();
         }
 
+        if (replay.isOpen() && replay_direction != 0)
+        {
+            uint64_t speed = (uint64_t)replay_speed;
+            uint64_t target = replay_direction > 0 ? replay.position + speed
+                                                   : (replay.position > speed ? replay.position - speed : 0);
+            replay.seek(target);
+            if (replay.position == 0 || replay.position >= replay.operations)
+                replay_direction = 0;
+        }
+
 //---------------------------------------------------------------------------------
 //          SORT WINDOWS
 //---------------------------------------------------------------------------------
-        if (show_shellsort_window || show_radixsort_window || show_bogosort_window)
+        if (show_shellsort_window || show_radixsort_window || show_bogosort_window || show_picked_window || replay.isOpen())
         {
             ImGui::Begin("Sort Window", nullptr, ImGuiWindowFlags_NoScrollbar);
-            if (render_charts)
+            // Bars and textures each keep their own copy, so a switch invalidates both
+            if (!render_charts || array_view != drawn_view)
+            {
+                resetDirty();
+                drawn_view = render_charts ? array_view : -1;
+            }
+            DirtySet changes;
+            // The MSD engine gets its bucket occupancy under the arrays
+            bool show_occupancy = render_charts && show_picked_window && bench_engines[picked_engine].sort == msdRadixSortEngine;
+            float occupancy_height = show_occupancy ? 160.0f : 0.0f;
+            if (render_charts && array_view != ArrayView_Bars)
+            {
+                int shown = show_shellsort_window + show_radixsort_window + show_bogosort_window + show_picked_window + replay.isOpen();
+                ImVec2 available = ImGui::GetContentRegionAvail();
+                available.y -= occupancy_height;
+                float line = ImGui::GetTextLineHeightWithSpacing() + ImGui::GetStyle().ItemSpacing.y;
+                ImVec2 image_size = ImVec2(available.x, std::max(1.0f, available.y / shown - line));
+                auto drawArray = [&](const char* label, ArrayTexture& texture, DirtyBlocks& dirty, const int* array, int number)
+                {
+                    ImGui::TextUnformatted(label);
+                    dirty.collect(changes);
+                    texture.update(renderer, array, number, (ArrayView)array_view, changes);
+                    texture.draw(image_size);
+                };
+                if (show_shellsort_window)
+                    drawArray("Shellsort", shell_texture, shell_dirty, shell_numbers, number_of_numbers);
+                if (show_radixsort_window)
+                    drawArray("Radix Sort", radix_texture, radix_dirty, radix_numbers, number_of_numbers);
+                if (show_bogosort_window)
+                    drawArray("Bogosort", bogo_texture, bogo_dirty, bogo_numbers, number_of_numbers);
+                if (show_picked_window)
+                    drawArray(bench_engines[picked_engine].name, picked_texture, picked_dirty, picked_numbers, number_of_numbers);
+                if (replay.isOpen())
+                    drawArray("Replay", replay_texture, replay.dirty, replay.array.data(), replay.number);
+            }
+            else if (render_charts)
             {
                 std::lock_guard<std::mutex> lock(numbers_mutex);
-                ImVec2 pivot_window_size = ImVec2(ImGui::GetWindowSize().x - 15, ImGui::GetWindowSize().y - 50);
+                ImVec2 pivot_window_size = ImVec2(ImGui::GetWindowSize().x - 15, ImGui::GetWindowSize().y - 50 - occupancy_height);
                 if (ImPlot::BeginPlot("My Plot", pivot_window_size)) {
-                    if (show_shellsort_window)
+                    auto plotArray = [&](const char* label, ArraySamples& samples, DirtyBlocks& dirty, const int* array, int number)
                     {
-                        auto downsampled = downsampleArray(shell_numbers, number_of_numbers);
-                        ImPlot::PlotBars("Shellsort", downsampled.data(), downsampled.size());
-                    }
+                        dirty.collect(changes);
+                        const std::vector<int>& downsampled = samples.update(array, number, changes);
+                        ImPlot::PlotBars(label, downsampled.data(), downsampled.size());
+                    };
+                    if (show_shellsort_window)
+                        plotArray("Shellsort", shell_samples, shell_dirty, shell_numbers, number_of_numbers);
                     if (show_radixsort_window)
-                    {
-                        auto downsampled = downsampleArray(radix_numbers, number_of_numbers);
-                        ImPlot::PlotBars("Radix Sort", downsampled.data(), downsampled.size());
-                    }
+                        plotArray("Radix Sort", radix_samples, radix_dirty, radix_numbers, number_of_numbers);
                     if (show_bogosort_window)
+                        plotArray("Bogosort", bogo_samples, bogo_dirty, bogo_numbers, number_of_numbers);
+                    if (show_picked_window)
+                        plotArray(bench_engines[picked_engine].name, picked_samples, picked_dirty, picked_numbers, number_of_numbers);
+                    if (replay.isOpen())
+                        plotArray("Replay", replay_samples, replay.dirty, replay.array.data(), replay.number);
+                    ImPlot::EndPlot();
+                    ImGui::Text("I recomend right-clicking the chart and X-Y-Axis auto-fitting");
+                }
+            }
+            if (show_occupancy)
+            {
+                // One row per level, one column per digit, log scaled so a few hot digits don't wash out the rest
+                int levels = msd_occupancy.deepest + 1;
+                occupancy_values.assign((size_t)std::max(levels, 1) * 256, 0.0f);
+                float hottest = 1.0f;
+                for (int level = 0; level < levels; level++)
+                    for (int digit = 0; digit < 256; digit++)
                     {
-                        auto downsampled = downsampleArray(bogo_numbers, number_of_numbers);
-                        ImPlot::PlotBars("Bogosort", downsampled.data(), downsampled.size());
+                        float value = (float)std::log10(1.0 + (double)msd_occupancy.counts[level][digit].load(std::memory_order_relaxed));
+                        occupancy_values[level * 256 + digit] = value;
+                        hottest = std::max(hottest, value);
                     }
+                if (ImPlot::BeginPlot("MSD bucket occupancy", ImVec2(-1, occupancy_height - ImGui::GetStyle().ItemSpacing.y), ImPlotFlags_NoLegend | ImPlotFlags_NoMouseText))
+                {
+                    ImPlot::SetupAxes("digit", "level", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_NoTickLabels);
+                    ImPlot::PlotHeatmap("##Occupancy", occupancy_values.data(), std::max(levels, 1), 256, 0.0, hottest, nullptr,
+                                        ImPlotPoint(0, 0), ImPlotPoint(256, std::max(levels, 1)));
                     ImPlot::EndPlot();
-                    ImGui::Text("I recomend right-clicking the chart and X-Y-Axis auto-fitting");
                 }
             }
             ImGui::End();
         }
   
+        if (show_throughput_window)
+        {
+            ImGui::Begin("Throughput", &show_throughput_window);
+            float plot_height = ImGui::GetContentRegionAvail().y * 0.5f - ImGui::GetStyle().ItemSpacing.y;
+            if (ImPlot::BeginPlot("##Throughput", ImVec2(-1, plot_height)))
+            {
+                ImPlot::SetupAxes("seconds", "operations / sec", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+                ImPlot::SetupAxis(ImAxis_Y2, "sortedness", ImPlotAxisFlags_AuxDefault);
+                ImPlot::SetupAxisLimits(ImAxis_Y2, 0.0, 1.0, ImPlotCond_Always);
+                for (int c = 0; c < sampler.channelCount(); c++)
+                {
+                    const ProgressSampler::Channel& channel = sampler.channel(c);
+                    channel.ring.snapshot(progress);
+                    if (progress.size() < 2)
+                        continue;
+                    progress_time.clear();
+                    progress_rate.clear();
+                    progress_sortedness.clear();
+                    for (size_t i = 1; i < progress.size(); i++)
+                    {
+                        double dt = progress[i].time_s - progress[i - 1].time_s;
+                        progress_time.push_back(progress[i].time_s);
+                        progress_rate.push_back(dt > 0.0 ? (progress[i].operations - progress[i - 1].operations) / dt : 0.0);
+                        progress_sortedness.push_back(progress[i].sortedness);
+                    }
+                    ImPlot::SetAxes(ImAxis_X1, ImAxis_Y1);
+                    ImPlot::PlotLine(channel.name, progress_time.data(), progress_rate.data(), (int)progress_time.size());
+                    std::string sortedness_label = std::string(channel.name) + " sortedness";
+                    ImPlot::SetAxes(ImAxis_X1, ImAxis_Y2);
+                    ImPlot::PlotLine(sortedness_label.c_str(), progress_time.data(), progress_sortedness.data(), (int)progress_time.size());
+                }
+                ImPlot::EndPlot();
+            }
+            // Every metric scaled to 0..1 so they share one axis, 0 is sorted for all but LIS
+            if (ImPlot::BeginPlot("##Disorder", ImVec2(-1, -1)))
+            {
+                ImPlot::SetupAxes("seconds", "share of worst case", ImPlotAxisFlags_AutoFit, 0);
+                ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, 1.0, ImPlotCond_Always);
+                for (int c = 0; c < sampler.channelCount(); c++)
+                {
+                    const ProgressSampler::Channel& channel = sampler.channel(c);
+                    channel.ring.snapshot(progress);
+                    if (progress.empty())
+                        continue;
+                    progress_time.clear();
+                    progress_inversions.clear();
+                    progress_runs.clear();
+                    progress_displacement.clear();
+                    progress_lis.clear();
+                    for (const ProgressSample& sample : progress)
+                    {
+                        double n = std::max(1, sample.metrics.number);
+                        double pairs = std::max(1.0, n * (n - 1) / 2);
+                        progress_time.push_back(sample.time_s);
+                        progress_inversions.push_back(sample.metrics.inversions / pairs);
+                        progress_runs.push_back(sample.metrics.runs / n);
+                        progress_displacement.push_back(sample.metrics.mean_displacement / n);
+                        progress_lis.push_back(sample.metrics.lis / n);
+                    }
+                    std::string name(channel.name);
+                    int count = (int)progress_time.size();
+                    ImPlot::PlotLine((name + " inversions").c_str(), progress_time.data(), progress_inversions.data(), count);
+                    ImPlot::PlotLine((name + " runs").c_str(), progress_time.data(), progress_runs.data(), count);
+                    ImPlot::PlotLine((name + " displacement").c_str(), progress_time.data(), progress_displacement.data(), count);
+                    ImPlot::PlotLine((name + " LIS").c_str(), progress_time.data(), progress_lis.data(), count);
+                }
+                ImPlot::EndPlot();
+            }
+            ImGui::End();
+        }
+
 //---------------------------------------------------------------------------------
 //          RENDERING
 //---------------------------------------------------------------------------------   
@@ -712,10 +7046,17 @@ int main(int, char**)
     }
 
     // Cleanup
-    delete[] numbers;
-    delete[] shell_numbers;
-    delete[] radix_numbers;
-    delete[] bogo_numbers;
+    sampler.stop();
+    shell_texture.destroy();
+    radix_texture.destroy();
+    bogo_texture.destroy();
+    picked_texture.destroy();
+    replay_texture.destroy();
+    freeKeys(numbers);
+    freeKeys(shell_numbers);
+    freeKeys(radix_numbers);
+    freeKeys(bogo_numbers);
+    freeKeys(picked_numbers);
 
     ImGui_ImplSDLRenderer2_Shutdown();
     ImGui_ImplSDL2_Shutdown();